@@ -6,6 +6,9 @@
 #include <windows.h>
 
 #include <set>
+#include <type_traits>
+#include <limits>
+#include <random>
 
 #include <TrivialTestKit.h>
 
@@ -27,6 +30,20 @@ std::string InnerLoadContentFromFile(const std::string& file_name) {
     return content;
 }
 
+std::string InnerLoadBinaryContentFromFile(const std::string& file_name) {
+    std::string content;
+
+    FILE* file = nullptr;
+    if (fopen_s(&file, file_name.c_str(), "rb") == 0 && file) {
+
+        int c;
+        while ((c = fgetc(file)) != EOF) content += char(c);
+        fclose(file);
+    }
+
+    return content;
+}
+
 bool CreateReadOnlyFile(const std::wstring& file_name) {
     HANDLE file_handle = CreateFileW(
         file_name.c_str(),
@@ -72,6 +89,11 @@ std::wstring CodeToTextUTF16(const uint16_t (&codes)[N]) {
     return std::wstring((const wchar_t*)codes);
 }
 
+template <unsigned N>
+std::u32string CodeToTextUTF32(const uint32_t (&codes)[N]) {
+    return std::u32string((const char32_t*)codes);
+}
+
 //------------------------------------------------------------------------------
 // Tests
 //------------------------------------------------------------------------------
@@ -161,6 +183,141 @@ void TestToUTF8() {
     }
 }
 
+void TestToUTF32() {
+    // empty text
+    TTK_ASSERT(ToUTF32(u8"") == U"");
+    TTK_ASSERT(ToUTF32(L"") == U"");
+    TTK_ASSERT(ToUTF8(U"") == u8"");
+    TTK_ASSERT(ToUTF16(U"") == L"");
+
+    // unicode characters
+    TTK_ASSERT(ToUTF32(u8"Some text\u0444\U0002F820.") == U"Some text\u0444\U0002F820.");
+    TTK_ASSERT(ToUTF32(L"Some text\u0444\U0002F820.") == U"Some text\u0444\U0002F820.");
+    TTK_ASSERT(ToUTF8(U"Some text\u0444\U0002F820.") == u8"Some text\u0444\U0002F820.");
+    TTK_ASSERT(ToUTF16(U"Some text\u0444\U0002F820.") == L"Some text\u0444\U0002F820.");
+
+    // long text
+    {
+        const std::string sequence_utf8 =  
+            u8"Some text\u0444. Some text\u0444. Some text\u0444. Some text\u0444. " 
+            u8"Some text. Some text. Some text. Some text. Some text. Some text. \U0002F820";
+
+        const std::u32string sequence_utf32 =  
+            U"Some text\u0444. Some text\u0444. Some text\u0444. Some text\u0444. " 
+            U"Some text. Some text. Some text. Some text. Some text. Some text. \U0002F820";
+
+        std::string long_text_utf8;
+        std::u32string long_text_utf32;
+
+        const size_t number = TOSTR_MIN_BUFFER_SIZE * 2 / sequence_utf8.length();
+        for (size_t ix = 0; ix < number; ++ix) {
+            long_text_utf8  += sequence_utf8;
+            long_text_utf32 += sequence_utf32;
+        }
+
+        TTK_ASSERT(ToUTF32(long_text_utf8) == long_text_utf32);
+        TTK_ASSERT(ToUTF8(long_text_utf32) == long_text_utf8);
+        TTK_ASSERT(ToUTF32(ToUTF16(long_text_utf8)) == long_text_utf32);
+        TTK_ASSERT(ToUTF16(long_text_utf32) == ToUTF16(long_text_utf8));
+    }
+
+    // returned text does not keep memory reserved for the worst case
+    {
+        std::string text_utf8;
+        for (size_t ix = 0; ix < TOSTR_MIN_BUFFER_SIZE; ++ix) text_utf8 += u8"\u0444";
+
+        const std::u32string text_utf32 = ToUTF32(text_utf8);
+        TTK_ASSERT(text_utf32.length() == TOSTR_MIN_BUFFER_SIZE);
+        TTK_ASSERT(text_utf32.capacity() < text_utf8.length());
+
+        const std::u32string other_text_utf32 = ToUTF32(ToUTF16(U"\U0002F820\U0002F820\U0002F820\U0002F820\U0002F820\U0002F820\U0002F820\U0002F820"
+                                                                U"\U0002F820\U0002F820\U0002F820\U0002F820\U0002F820\U0002F820\U0002F820\U0002F820"));
+        TTK_ASSERT(other_text_utf32.length() == 16);
+        TTK_ASSERT(other_text_utf32.capacity() < 32);
+    }
+
+    // into existing string
+    {
+        std::u32string text_utf32 = U"previous content";
+        ToUTF32(u8"text\u0444", text_utf32);
+        TTK_ASSERT(text_utf32 == U"text\u0444");
+
+        std::string text_utf8 = "previous content";
+        ToUTF8(U"text\u0444", text_utf8);
+        TTK_ASSERT(text_utf8 == u8"text\u0444");
+
+        std::wstring text_utf16 = L"previous content";
+        ToUTF16(U"text\U0002F820", text_utf16);
+        TTK_ASSERT(text_utf16 == L"text\U0002F820");
+    }
+
+    // wrong encoding, the same as for ToUTF16 and ToUTF8
+    {
+        // U+FFFD - Replacement Character
+        TTK_ASSERT(ToUTF32(CodeToTextUTF8({0xC2, 'e', 'x', 't', '\0'})) == CodeToTextUTF32({0xFFFD, 'e', 'x', 't', '\0'}));
+        TTK_ASSERT(ToUTF32(CodeToTextUTF8({0xFF, 'e', 'x', 't', '\0'})) == CodeToTextUTF32({0xFFFD, 'e', 'x', 't', '\0'}));
+        TTK_ASSERT(ToUTF32(CodeToTextUTF8({0xED, 0xA0, 0x80, 't', '\0'})) == CodeToTextUTF32({0xFFFD, 0xFFFD, 0xFFFD, 't', '\0'}));  // surrogate
+        TTK_ASSERT(ToUTF32(CodeToTextUTF8({0xE0, 0x80, 0x80, 't', '\0'})) == CodeToTextUTF32({0xFFFD, 0xFFFD, 0xFFFD, 't', '\0'}));  // overlong
+        TTK_ASSERT(ToUTF32(CodeToTextUTF8({0xF0, 0x9F, 0x98, 't', '\0'})) == CodeToTextUTF32({0xFFFD, 't', '\0'}));                  // truncated
+
+        TTK_ASSERT(ToUTF32(CodeToTextUTF16({0xDC00, 'e', 'x', 't', '\0'})) == CodeToTextUTF32({0xFFFD, 'e', 'x', 't', '\0'}));
+        TTK_ASSERT(ToUTF32(CodeToTextUTF16({0xD800, 'e', 'x', 't', '\0'})) == CodeToTextUTF32({0xFFFD, 'e', 'x', 't', '\0'}));
+
+        // U+FFFD - Replacement Character (EF BF BD in utf8)
+        TTK_ASSERT(ToUTF8(CodeToTextUTF32({0xD800, 'e', 'x', 't', '\0'})) == CodeToTextUTF8({0xEF, 0xBF, 0xBD, 'e', 'x', 't', '\0'}));
+        TTK_ASSERT(ToUTF8(CodeToTextUTF32({0x110000, 'e', 'x', 't', '\0'})) == CodeToTextUTF8({0xEF, 0xBF, 0xBD, 'e', 'x', 't', '\0'}));
+        TTK_ASSERT(ToUTF16(CodeToTextUTF32({0xDC00, 'e', 'x', 't', '\0'})) == CodeToTextUTF16({0xFFFD, 'e', 'x', 't', '\0'}));
+    }
+}
+
+void TestLatin1() {
+    // empty text
+    TTK_ASSERT(Latin1ToUTF8("") == u8"");
+    TTK_ASSERT(ToLatin1(u8"") == "");
+
+    // latin1 characters
+    TTK_ASSERT(Latin1ToUTF8("Some text \xE6\xF3\xFF.") == u8"Some text \u00E6\u00F3\u00FF.");
+    TTK_ASSERT(ToLatin1(u8"Some text \u00E6\u00F3\u00FF.") == "Some text \xE6\xF3\xFF.");
+
+    // long text
+    {
+        std::string long_text_latin1;
+        for (size_t ix = 0; ix < TOSTR_MIN_BUFFER_SIZE; ++ix) long_text_latin1 += char(ix % 256 ? ix % 256 : 'a');
+
+        TTK_ASSERT(ToLatin1(Latin1ToUTF8(long_text_latin1)) == long_text_latin1);
+    }
+
+    // returned text does not keep memory reserved for the worst case
+    {
+        const std::string text_utf8 = Latin1ToUTF8(std::string(TOSTR_MIN_BUFFER_SIZE, 'a'));
+        TTK_ASSERT(text_utf8.length() == TOSTR_MIN_BUFFER_SIZE);
+        TTK_ASSERT(text_utf8.capacity() < TOSTR_MIN_BUFFER_SIZE * 2);
+
+        std::string long_text_utf8;
+        for (size_t ix = 0; ix < TOSTR_MIN_BUFFER_SIZE; ++ix) long_text_utf8 += u8"\u00E6";
+
+        const std::string text_latin1 = ToLatin1(long_text_utf8);
+        TTK_ASSERT(text_latin1.length() == TOSTR_MIN_BUFFER_SIZE);
+        TTK_ASSERT(text_latin1.capacity() < long_text_utf8.length());
+    }
+
+    // into existing string
+    {
+        std::string text = "previous content";
+        Latin1ToUTF8("\xE6", text);
+        TTK_ASSERT(text == u8"\u00E6");
+
+        ToLatin1(u8"\u00F3", text);
+        TTK_ASSERT(text == "\xF3");
+    }
+
+    // not in latin1, wrong encoding
+    {
+        TTK_ASSERT(ToLatin1(u8"text\u0444\U0002F820.") == "text??.");
+        TTK_ASSERT(ToLatin1(CodeToTextUTF8({0xC2, 'e', 'x', 't', '\0'})) == "?ext");
+    }
+}
+
 void TestLoadSave() {
     TTK_ASSERT(CreateDirectoryA(".\\log", 0) || GetLastError() == ERROR_ALREADY_EXISTS);
     TTK_ASSERT(CreateDirectoryA(".\\log\\test", 0) || GetLastError() == ERROR_ALREADY_EXISTS);
@@ -436,6 +593,355 @@ void TestLoadSave() {
     }
 }
 
+void TestSaveUTF16() {
+    TTK_ASSERT(CreateDirectoryA(".\\log", 0) || GetLastError() == ERROR_ALREADY_EXISTS);
+    TTK_ASSERT(CreateDirectoryA(".\\log\\test", 0) || GetLastError() == ERROR_ALREADY_EXISTS);
+
+    auto ToBytes = [](const std::wstring& text_utf16, ToStr_ByteOrder byte_order) -> std::string {
+        std::string bytes;
+        for (wchar_t unit : text_utf16) {
+            const char low  = char(unit & 0xFF);
+            const char high = char((unit >> 8) & 0xFF);
+
+            if (byte_order == TOSTR_BYTE_ORDER_LE) {
+                bytes += low;
+                bytes += high;
+            } else {
+                bytes += high;
+                bytes += low;
+            }
+        }
+        return bytes;
+    };
+
+    const std::string text = u8"Some text\n\uD558\u0444\U00020001\r\n.";
+    const std::string text_crlf = u8"Some text\r\n\uD558\u0444\U00020001\r\n.";
+
+    // utf16, byte orders, BOM
+    for (ToStr_ByteOrder byte_order : {TOSTR_BYTE_ORDER_LE, TOSTR_BYTE_ORDER_BE}) {
+        const std::string file_name = u8"log\\test\\TestSaveUTF16_\u0107\u0119\u0144.txt";
+
+        TTK_ASSERT(SaveTextToFileUTF16(file_name, text, byte_order));
+        TTK_ASSERT(InnerLoadBinaryContentFromFile(file_name) == ToBytes(ToUTF16(text), byte_order));
+
+        TTK_ASSERT(SaveTextToFileUTF16_BOM(file_name, text, byte_order));
+        TTK_ASSERT(InnerLoadBinaryContentFromFile(file_name) == ToBytes(L"\xFEFF" + ToUTF16(text), byte_order));
+
+        TTK_ASSERT(SaveTextToFileUTF16(file_name, text, byte_order, TOSTR_NEW_LINE_CRLF));
+        TTK_ASSERT(InnerLoadBinaryContentFromFile(file_name) == ToBytes(ToUTF16(text_crlf), byte_order));
+    }
+
+    // utf16, empty text
+    {
+        const std::string file_name = u8"log\\test\\TestSaveUTF16_EmptyFile_\u0107\u0119\u0144.txt";
+
+        TTK_ASSERT(SaveTextToFileUTF16(file_name, ""));
+        TTK_ASSERT(InnerLoadBinaryContentFromFile(file_name) == "");
+
+        TTK_ASSERT(SaveTextToFileUTF16_BOM(file_name, ""));
+        TTK_ASSERT(InnerLoadBinaryContentFromFile(file_name) == "\xFF\xFE");
+    }
+
+    // utf16, long text (many chunks)
+    {
+        const std::string file_name = u8"log\\test\\TestSaveUTF16_Long_\u0107\u0119\u0144.txt";
+
+        std::string long_text;
+        for (size_t index = 0; index < TOSTR_MIN_BUFFER_SIZE; ++index) long_text += text;
+
+        TTK_ASSERT(SaveTextToFileUTF16(file_name, long_text));
+        TTK_ASSERT(InnerLoadBinaryContentFromFile(file_name) == ToBytes(ToUTF16(long_text), TOSTR_BYTE_ORDER_LE));
+    }
+
+    // utf16, wrong encoding
+    {
+        const std::string file_name = "log\\test\\TestSaveUTF16_WrongEncoding.txt";
+
+        TTK_ASSERT(SaveTextToFileUTF16(file_name, CodeToTextUTF8({0xC2, 'e', 'x', 't', '\0'})));
+        TTK_ASSERT(InnerLoadBinaryContentFromFile(file_name) == ToBytes(CodeToTextUTF16({0xFFFD, 'e', 'x', 't', '\0'}), TOSTR_BYTE_ORDER_LE));
+    }
+
+    // try save to read only, utf16
+    {
+        const std::string file_name = u8"log\\test\\TestSaveUTF16_TrySaveToReadOnly_\u0107\u0119\u0144.txt";
+
+        TTK_ASSERT(CreateReadOnlyFile(ToUTF16(file_name)));
+        TTK_ASSERT(!SaveTextToFileUTF16(file_name, text));
+        TTK_ASSERT(!SaveTextToFileUTF16_BOM(file_name, text));
+    }
+
+    // utf8, crlf
+    {
+        const std::string file_name = u8"log\\test\\TestSaveUTF8_CRLF_\u0107\u0119\u0144.txt";
+
+        TTK_ASSERT(SaveTextToFileUTF8(file_name, text, TOSTR_NEW_LINE_CRLF));
+        TTK_ASSERT(InnerLoadBinaryContentFromFile(file_name) == text_crlf);
+        TTK_ASSERT(LoadTextFromFileUTF8(file_name) == u8"Some text\n\uD558\u0444\U00020001\n.");
+
+        TTK_ASSERT(SaveTextToFileUTF8_BOM(file_name, text, TOSTR_NEW_LINE_CRLF));
+        TTK_ASSERT(InnerLoadBinaryContentFromFile(file_name) == "\xEF\xBB\xBF" + text_crlf);
+    }
+}
+
+void TestLoadTextFromFiles() {
+    TTK_ASSERT(CreateDirectoryA(".\\log", 0) || GetLastError() == ERROR_ALREADY_EXISTS);
+    TTK_ASSERT(CreateDirectoryA(".\\log\\test", 0) || GetLastError() == ERROR_ALREADY_EXISTS);
+
+    const std::string expected_content = u8"Some text\n\uD558\u0444\U00020001\n.";
+
+    // utf8, many files, order and status
+    {
+        std::vector<std::string> file_names;
+
+        for (size_t index = 0; index < 64; ++index) {
+            const std::string file_name = ToStr(u8"log\\test\\TestLoadTextFromFiles_\u0107\u0119\u0144_%zu.txt", index);
+
+            TTK_ASSERT(SaveTextToFileUTF8(file_name, ToStr("%zu\r\n", index) + expected_content));
+            file_names.push_back(file_name);
+        }
+        file_names.push_back(u8"log\\test\\TestLoadTextFromFiles_NotExisting_\u0107\u0119\u0144.txt");
+
+        const std::vector<LoadedTextFile> loaded_files = LoadTextFromFiles(file_names);
+
+        TTK_ASSERT(loaded_files.size() == file_names.size());
+        for (size_t index = 0; index < 64; ++index) {
+            TTK_ASSERT(loaded_files[index].is_loaded);
+            TTK_ASSERT(loaded_files[index].text == ToStr("%zu\n", index) + expected_content);
+        }
+        TTK_ASSERT(!loaded_files.back().is_loaded);
+        TTK_ASSERT(loaded_files.back().text == "");
+
+        // single thread
+        const std::vector<LoadedTextFile> loaded_files_st = LoadTextFromFiles(file_names, TOSTR_LOAD_MODE_UTF8, 1);
+
+        TTK_ASSERT(loaded_files_st.size() == file_names.size());
+        for (size_t index = 0; index < file_names.size(); ++index) {
+            TTK_ASSERT(loaded_files_st[index].is_loaded == loaded_files[index].is_loaded);
+            TTK_ASSERT(loaded_files_st[index].text == loaded_files[index].text);
+        }
+    }
+
+    // utf8 BOM
+    {
+        const std::string file_name = u8"log\\test\\TestLoadTextFromFiles_\u0107\u0119\u0144_BOM.txt";
+
+        TTK_ASSERT(SaveTextToFileUTF8_BOM(file_name, expected_content));
+
+        const std::vector<LoadedTextFile> loaded_files = LoadTextFromFiles({file_name, file_name}, TOSTR_LOAD_MODE_UTF8_BOM);
+
+        TTK_ASSERT(loaded_files.size() == 2);
+        TTK_ASSERT(loaded_files[0].is_loaded && loaded_files[0].text == expected_content);
+        TTK_ASSERT(loaded_files[1].is_loaded && loaded_files[1].text == expected_content);
+    }
+
+    // no files
+    TTK_ASSERT(LoadTextFromFiles({}).empty());
+}
+
+void TestTextFileCache() {
+    TTK_ASSERT(CreateDirectoryA(".\\log", 0) || GetLastError() == ERROR_ALREADY_EXISTS);
+    TTK_ASSERT(CreateDirectoryA(".\\log\\test", 0) || GetLastError() == ERROR_ALREADY_EXISTS);
+
+    const std::string expected_content = u8"Some text\n\uD558\u0444\U00020001\n.";
+
+    // shared text, revalidation
+    {
+        const std::string file_name = u8"log\\test\\TestTextFileCache_\u0107\u0119\u0144.txt";
+
+        TTK_ASSERT(SaveTextToFileUTF8(file_name, expected_content));
+
+        TextFileCache cache;
+
+        bool is_loaded = false;
+        std::shared_ptr<const std::string> text = cache.Load(file_name, &is_loaded);
+
+        TTK_ASSERT(is_loaded);
+        TTK_ASSERT(text && *text == expected_content);
+        TTK_ASSERT(cache.GetByteSize() == expected_content.size());
+
+        // unchanged file, the same text
+        TTK_ASSERT(cache.Load(file_name) == text);
+
+        // changed file
+        TTK_ASSERT(SaveTextToFileUTF8(file_name, expected_content + "\r\nmore"));
+
+        std::shared_ptr<const std::string> changed_text = cache.Load(file_name, &is_loaded);
+
+        TTK_ASSERT(is_loaded);
+        TTK_ASSERT(changed_text != text);
+        TTK_ASSERT(*changed_text == expected_content + "\nmore");
+        TTK_ASSERT(*text == expected_content); // previously returned text stays valid
+        TTK_ASSERT(cache.GetByteSize() == changed_text->size());
+
+        cache.Remove(file_name);
+        TTK_ASSERT(cache.GetByteSize() == 0);
+        TTK_ASSERT(cache.Load(file_name) != changed_text);
+    }
+
+    // not existing
+    {
+        TextFileCache cache;
+
+        bool is_loaded = true;
+        std::shared_ptr<const std::string> text = cache.Load(u8"log\\test\\TestTextFileCache_NotExisting_\u0107\u0119\u0144.txt", &is_loaded);
+
+        TTK_ASSERT(!is_loaded);
+        TTK_ASSERT(text && *text == "");
+        TTK_ASSERT(cache.GetByteSize() == 0);
+    }
+
+    // not existing, then created
+    {
+        const std::string file_name = "log\\test\\TestTextFileCache_Created.txt";
+
+        DeleteFileA(file_name.c_str());
+
+        TextFileCache cache;
+
+        bool is_loaded = true;
+        std::shared_ptr<const std::string> text = cache.Load(file_name, &is_loaded);
+
+        TTK_ASSERT(!is_loaded);
+        TTK_ASSERT(text && *text == "");
+
+        TTK_ASSERT(SaveTextToFileUTF8(file_name, expected_content));
+
+        text = cache.Load(file_name, &is_loaded);
+
+        TTK_ASSERT(is_loaded);
+        TTK_ASSERT(text && *text == expected_content);
+        TTK_ASSERT(cache.GetByteSize() == expected_content.size());
+    }
+
+    // eviction
+    {
+        const std::string file_name_a = "log\\test\\TestTextFileCache_A.txt";
+        const std::string file_name_b = "log\\test\\TestTextFileCache_B.txt";
+
+        TTK_ASSERT(SaveTextToFileUTF8(file_name_a, expected_content));
+        TTK_ASSERT(SaveTextToFileUTF8(file_name_b, expected_content));
+
+        TextFileCache cache(expected_content.size() * 3 / 2);
+
+        std::shared_ptr<const std::string> text_a = cache.Load(file_name_a);
+        std::shared_ptr<const std::string> text_b = cache.Load(file_name_b); // evicts a
+
+        TTK_ASSERT(cache.GetByteSize() == expected_content.size());
+        TTK_ASSERT(cache.Load(file_name_b) == text_b);
+        TTK_ASSERT(cache.Load(file_name_a) != text_a);
+
+        cache.SetByteBudget(0);
+        TTK_ASSERT(cache.GetByteSize() == 0);
+
+        cache.Clear();
+        TTK_ASSERT(cache.GetByteSize() == 0);
+    }
+
+    // concurrent loads
+    {
+        const std::string file_name = "log\\test\\TestTextFileCache_Concurrent.txt";
+
+        TTK_ASSERT(SaveTextToFileUTF8(file_name, expected_content));
+
+        TextFileCache cache;
+
+        std::shared_ptr<const std::string> texts[8];
+        std::vector<std::thread> threads;
+
+        for (auto& text : texts) {
+            threads.emplace_back([&cache, &file_name, &text]() { text = cache.Load(file_name); });
+        }
+        for (auto& thread : threads) thread.join();
+
+        for (const auto& text : texts) TTK_ASSERT(text == texts[0]);
+        TTK_ASSERT(*texts[0] == expected_content);
+    }
+}
+
+void TestLineIndex() {
+    // empty text
+    {
+        LineIndex line_index("");
+
+        TTK_ASSERT(line_index.GetLineCount() == 0);
+        TTK_ASSERT(line_index.Split(4).empty());
+    }
+
+    // lines
+    {
+        const std::string text = "first\n\nthird\r\nfourth";
+
+        LineIndex line_index(text);
+
+        TTK_ASSERT(line_index.GetLineCount() == 4);
+        TTK_ASSERT(line_index.GetLine(0) == "first");
+        TTK_ASSERT(line_index.GetLine(1) == "");
+        TTK_ASSERT(line_index.GetLine(2) == "third\r");
+        TTK_ASSERT(line_index.GetLine(3) == "fourth");
+        TTK_ASSERT(line_index.GetText({1, 3}) == "\nthird\r\nfourth");
+    }
+
+    // crlf
+    {
+        const std::string text = "first\r\n\r\nthird\r\n";
+
+        LineIndex line_index(text, true);
+
+        TTK_ASSERT(line_index.GetLineCount() == 3);
+        TTK_ASSERT(line_index.GetLine(0) == "first");
+        TTK_ASSERT(line_index.GetLine(1) == "");
+        TTK_ASSERT(line_index.GetLine(2) == "third");
+        TTK_ASSERT(line_index.GetText({0, 3}) == "first\r\n\r\nthird");
+    }
+
+    // long text, split
+    {
+        std::string text;
+        for (size_t index = 0; index < 1000; ++index) text += ToStr("line %zu\n", index);
+
+        LineIndex line_index(text);
+
+        TTK_ASSERT(line_index.GetLineCount() == 1000);
+        TTK_ASSERT(line_index.GetLine(0) == "line 0");
+        TTK_ASSERT(line_index.GetLine(567) == "line 567");
+        TTK_ASSERT(line_index.GetLine(999) == "line 999");
+
+        const std::vector<LineIndex::Range> ranges = line_index.Split(7);
+
+        TTK_ASSERT(ranges.size() == 7);
+
+        size_t first = 0;
+        for (const auto& range : ranges) {
+            TTK_ASSERT(range.first == first);
+            TTK_ASSERT(range.count > 0);
+            first += range.count;
+        }
+        TTK_ASSERT(first == 1000);
+    }
+
+    // text without '\n'
+    {
+        LineIndex line_index("only line");
+
+        TTK_ASSERT(line_index.GetLineCount() == 1);
+        TTK_ASSERT(line_index.GetLine(0) == "only line");
+        TTK_ASSERT(line_index.GetText({0, 1}) == "only line");
+        TTK_ASSERT(line_index.Split(3).size() == 1);
+    }
+
+    // split into more ranges than text size
+    {
+        LineIndex line_index("a\nb\nc");
+
+        const std::vector<LineIndex::Range> ranges = line_index.Split(10);
+
+        TTK_ASSERT(ranges.size() == 3);
+        for (size_t index = 0; index < ranges.size(); ++index) {
+            TTK_ASSERT(ranges[index].first == index && ranges[index].count == 1);
+        }
+    }
+}
+
 void TestToStr() {
     // empty string
     TTK_ASSERT(ToStr("") == std::string(""));
@@ -475,6 +981,682 @@ void TestToStr() {
     // ToStr("%d %d", 4);   // not enough arguments
 }
 
+template <typename... Types>
+std::string InnerFormatBySnprintf(const char* format, Types... arguments) {
+    char buffer[1024];
+    const int length = snprintf(buffer, sizeof(buffer), format, arguments...);
+    return (length >= 0) ? std::string(buffer, length) : std::string();
+}
+
+enum InnerColor { INNER_COLOR_RED = 3 };
+enum class InnerShape : uint8_t { CIRCLE = 200 };
+
+void TestToStrArguments() {
+    // the same as from 'snprintf'
+    {
+        int value = 0;
+
+        TTK_ASSERT(ToStr("%d %i %u %o %x %X", -42, 42, 42u, 42, -1, 255) == InnerFormatBySnprintf("%d %i %u %o %x %X", -42, 42, 42u, 42, -1, 255));
+        TTK_ASSERT(ToStr("%hhd %hd %hhu %hu", 300, 70000, 300, -1) == InnerFormatBySnprintf("%hhd %hd %hhu %hu", 300, 70000, 300, -1));
+        TTK_ASSERT(ToStr("%ld %lu %lx", -5L, 5UL, 0xABCUL) == InnerFormatBySnprintf("%ld %lu %lx", -5L, 5UL, 0xABCUL));
+        TTK_ASSERT(ToStr("%lld %llu", (std::numeric_limits<long long>::min)(), (std::numeric_limits<unsigned long long>::max)()) == 
+            InnerFormatBySnprintf("%lld %llu", (std::numeric_limits<long long>::min)(), (std::numeric_limits<unsigned long long>::max)()));
+        TTK_ASSERT(ToStr("%zu %zd %td %jd", size_t(7), ptrdiff_t(-7), ptrdiff_t(8), intmax_t(-9)) == 
+            InnerFormatBySnprintf("%zu %zd %td %jd", size_t(7), ptrdiff_t(-7), ptrdiff_t(8), intmax_t(-9)));
+        TTK_ASSERT(ToStr("%I64d %I64u %I32d", -5LL, 5ULL, -6) == InnerFormatBySnprintf("%I64d %I64u %I32d", -5LL, 5ULL, -6));
+        TTK_ASSERT(ToStr("[%5d|%-5d|%05d|%+d|% d|%#x|%.3d]", 1, 2, 3, 4, 5, 6, 7) == InnerFormatBySnprintf("[%5d|%-5d|%05d|%+d|% d|%#x|%.3d]", 1, 2, 3, 4, 5, 6, 7));
+        TTK_ASSERT(ToStr("%c%c%c", 'a', 98, char(99)) == "abc");
+
+        TTK_ASSERT(ToStr("%f %.2f %e %E %g %G %a", 3.14159, 2.5f, 1e-7, 1e20, 0.0001, 1e100, 1.0) == 
+            InnerFormatBySnprintf("%f %.2f %e %E %g %G %a", 3.14159, 2.5f, 1e-7, 1e20, 0.0001, 1e100, 1.0));
+        TTK_ASSERT(ToStr("%Lf %.3Le", 1.5L, 2.25L) == InnerFormatBySnprintf("%Lf %.3Le", 1.5L, 2.25L));
+
+        TTK_ASSERT(ToStr("%p %p", &value, nullptr) == InnerFormatBySnprintf("%p %p", (void*)&value, (void*)nullptr));
+        TTK_ASSERT(ToStr("[%10s|%-10s|%.2s]", "abc", "def", "ghi") == "[       abc|def       |gh]");
+        TTK_ASSERT(ToStr("%ls", L"wide") == "wide");
+
+        TTK_ASSERT(ToStr("100%% %d%%", 5) == "100% 5%");
+    }
+
+    // width and precision as '*'
+    {
+        TTK_ASSERT(ToStr("[%*d|%-*d|%*d]", 5, 1, 4, 2, -4, 3) == "[    1|2   |3   ]");
+        TTK_ASSERT(ToStr("[%.*f|%*.*f]", 2, 3.14159, 8, 3, 2.5) == "[3.14|   2.500]");
+        TTK_ASSERT(ToStr("[%.*s|%.*s]", 2, "abcdef", -1, "abcdef") == "[ab|abcdef]");
+    }
+
+    // enumerations
+    {
+        TTK_ASSERT(ToStr("%d %u", INNER_COLOR_RED, unsigned(InnerShape::CIRCLE)) == "3 200");
+
+        const ToStr_Argument argument = ToStr_ToArgument(InnerShape::CIRCLE);
+        TTK_ASSERT(argument.type == TOSTR_ARGUMENT_TYPE_UNSIGNED && argument.unsigned_value == 200);
+    }
+
+    // string and character arrays
+    {
+        char        text[]      = "text";
+        const char  other_text[] = "other";
+
+        TTK_ASSERT(ToStr("%s %s", text, other_text) == "text other");
+    }
+
+    // formatting function
+    {
+        const ToStr_Argument arguments[] = {ToStr_ToArgument("abc"), ToStr_ToArgument(12345)};
+
+        char buffer[16];
+
+        TTK_ASSERT(ToStr_FormatToBuffer(buffer, sizeof(buffer), "%s-%d!", arguments, 2) == 10);
+        TTK_ASSERT(std::string(buffer) == "abc-12345!");
+
+        // truncated
+        TTK_ASSERT(ToStr_FormatToBuffer(buffer, 6, "%s-%d!", arguments, 2) == 10);
+        TTK_ASSERT(std::string(buffer) == "abc-1");
+
+        TTK_ASSERT(ToStr_FormatToBuffer(buffer, 2, "%s-%d!", arguments, 2) == 10);
+        TTK_ASSERT(std::string(buffer) == "a");
+
+        TTK_ASSERT(ToStr_FormatToBuffer(nullptr, 0, "%s-%d!", arguments, 2) == 10);
+
+        // arguments which do not match format
+        TTK_ASSERT(ToStr_FormatToBuffer(buffer, sizeof(buffer), "%s %d %d", arguments, 2) == TOSTR_FORMAT_ERROR_ARGUMENTS);
+        TTK_ASSERT(ToStr_FormatToBuffer(buffer, sizeof(buffer), "%f", arguments + 1, 1) == TOSTR_FORMAT_ERROR_ARGUMENTS);
+        TTK_ASSERT(ToStr_FormatToBuffer(buffer, sizeof(buffer), "%n", arguments + 1, 1) == TOSTR_FORMAT_ERROR_ARGUMENTS);
+        TTK_ASSERT(ToStr_FormatToBuffer(buffer, sizeof(buffer), "%", arguments, 0) == TOSTR_FORMAT_ERROR_ARGUMENTS);
+    }
+
+    // other functions
+    {
+        TTK_ASSERT(std::string_view(ToStrFixed<8>("%*d|%s", 3, 7, "abcdef")) == "  7|abcd");
+        TTK_ASSERT(ToStrBuilder().Append("%d,", 1).Append("%.1f", 2.5).ToString() == "1,2.5");
+    }
+}
+
+void TestToStrFixed() {
+    static_assert(std::is_trivially_copyable<FixedString<16>>::value, "FixedString must be trivially copyable.");
+
+    // empty string
+    {
+        const FixedString<16> text = ToStrFixed<16>("");
+
+        TTK_ASSERT(text.IsEmpty());
+        TTK_ASSERT(!text.IsTruncated());
+        TTK_ASSERT(std::string_view(text) == "");
+    }
+
+    // pass through
+    {
+        TTK_ASSERT(std::string_view(ToStrFixed<32>("50% done")) == "50% done");
+        TTK_ASSERT(std::string_view(ToStrFixed<32>("100%%")) == "100%%");
+        TTK_ASSERT(std::string_view(ToStrFixed<3>("abcd")) == "abc");
+        TTK_ASSERT(ToStrFixed<3>("abcd").IsTruncated());
+    }
+
+    // convert to text
+    {
+        const FixedString<32> text = ToStrFixed<32>("%s %d %.2f", "text", 123, 3.14);
+
+        TTK_ASSERT(!text.IsTruncated());
+        TTK_ASSERT(text.GetLength() == 13);
+        TTK_ASSERT(std::string_view(text) == "text 123 3.14");
+        TTK_ASSERT(strcmp(text.ToCStr(), "text 123 3.14") == 0);
+    }
+
+    // exact fit
+    {
+        const FixedString<4> text = ToStrFixed<4>("%s", "abcd");
+
+        TTK_ASSERT(!text.IsTruncated());
+        TTK_ASSERT(std::string_view(text) == "abcd");
+    }
+
+    // truncation
+    {
+        const FixedString<4> text = ToStrFixed<4>("%s", "abcdef");
+
+        TTK_ASSERT(text.IsTruncated());
+        TTK_ASSERT(std::string_view(text) == "abcd");
+        TTK_ASSERT(strcmp(text.ToCStr(), "abcd") == 0);
+    }
+
+    // truncation, does not break utf8 sequence
+    {
+        const FixedString<4> text = ToStrFixed<4>("%s", u8"ab\u0444\u0444");
+
+        TTK_ASSERT(text.IsTruncated());
+        TTK_ASSERT(std::string_view(text) == u8"ab\u0444");
+
+        const FixedString<5> other_text(u8"ab\U0002F820");
+
+        TTK_ASSERT(other_text.IsTruncated());
+        TTK_ASSERT(std::string_view(other_text) == "ab");
+    }
+
+    // copy
+    {
+        const FixedString<16> text = ToStrFixed<16>("%d", 42);
+        FixedString<16> copy;
+        copy = text;
+
+        TTK_ASSERT(std::string_view(copy) == "42");
+    }
+
+    // passing to other functions
+    {
+        const FixedString<32> text = ToStrFixed<32>("%s", u8"Some text\u0444.");
+
+        TTK_ASSERT(ToUTF16(text) == L"Some text\u0444.");
+        TTK_ASSERT(FixedString<32>(ToUTF8(ToUTF16(text))).IsTruncated() == false);
+    }
+}
+
+void TestToStrBuilder() {
+    // empty
+    {
+        ToStrBuilder builder;
+
+        TTK_ASSERT(builder.IsEmpty());
+        TTK_ASSERT(builder.GetLength() == 0);
+        TTK_ASSERT(builder.ToString() == "");
+    }
+
+    // parts
+    {
+        ToStrBuilder builder;
+
+        builder.Append("%s %d %.2f", "text", 123, 3.14).Append(", ").Append(std::string("abc")).Append(std::string_view("%d"));
+
+        TTK_ASSERT(builder.GetLength() == 20);
+        TTK_ASSERT(builder.ToString() == "text 123 3.14, abc%d");
+    }
+
+    // many parts, small chunks
+    for (size_t chunk_size : {size_t(1), size_t(7), size_t(64), size_t(ToStrBuilder::DEFAULT_CHUNK_SIZE)}) {
+        ToStrBuilder builder(chunk_size);
+        std::string expected_text;
+
+        for (int index = 0; index < 1000; ++index) {
+            builder.Append("<%d>", index);
+            builder.Append(u8"\u0444");
+            expected_text += ToStr("<%d>", index) + u8"\u0444";
+        }
+
+        const std::string long_part(TOSTR_MIN_BUFFER_SIZE * 2, 'x');
+        builder.Append("%s", long_part.c_str());
+        builder.Append(long_part);
+        expected_text += long_part + long_part;
+
+        TTK_ASSERT(builder.GetLength() == expected_text.length());
+        TTK_ASSERT(builder.ToString() == expected_text);
+
+        builder.Clear();
+        TTK_ASSERT(builder.IsEmpty());
+        TTK_ASSERT(builder.Append("%d", 1).ToString() == "1");
+    }
+
+    // save to file
+    {
+        TTK_ASSERT(CreateDirectoryA(".\\log", 0) || GetLastError() == ERROR_ALREADY_EXISTS);
+        TTK_ASSERT(CreateDirectoryA(".\\log\\test", 0) || GetLastError() == ERROR_ALREADY_EXISTS);
+
+        const std::string file_name = u8"log\\test\\TestToStrBuilder_\u0107\u0119\u0144.txt";
+
+        ToStrBuilder builder(16);
+        for (int index = 0; index < 100; ++index) builder.Append(u8"line %d \u0444\n", index);
+
+        TTK_ASSERT(SaveTextToFileUTF8(file_name, builder));
+
+        bool is_loaded = false;
+        const std::string content = LoadTextFromFileUTF8(file_name, &is_loaded);
+
+        TTK_ASSERT(is_loaded);
+        TTK_ASSERT(content == builder.ToString());
+    }
+}
+
+void TestToStrPrint() {
+    TTK_ASSERT(CreateDirectoryA(".\\log", 0) || GetLastError() == ERROR_ALREADY_EXISTS);
+    TTK_ASSERT(CreateDirectoryA(".\\log\\test", 0) || GetLastError() == ERROR_ALREADY_EXISTS);
+
+    // narrow file
+    {
+        const std::string file_name = "log\\test\\TestToStrPrint.txt";
+        const std::string long_text(TOSTR_MIN_BUFFER_SIZE * 2, 'x');
+
+        FILE* file = nullptr;
+        TTK_ASSERT(fopen_s(&file, file_name.c_str(), "wb") == 0 && file);
+
+        TTK_ASSERT(ToStrPrint(file, "%s %d %.2f\n", "text", 123, 3.14));
+        TTK_ASSERT(ToStrPrint(file, u8"%d \u0444%%\n"));
+        TTK_ASSERT(ToStrPrint(file, std::string("%d\n")));
+        TTK_ASSERT(ToStrPrint(file, ""));
+        TTK_ASSERT(ToStrPrint(file, "%s", long_text.c_str()));
+
+        fclose(file);
+
+        TTK_ASSERT(LoadTextFromFileUTF8(file_name) == u8"text 123 3.14\n%d \u0444%%\n%d\n" + long_text);
+    }
+
+    // flush modes
+    for (ToStr_FlushMode flush_mode : {TOSTR_FLUSH_MODE_EACH, TOSTR_FLUSH_MODE_BATCHED, TOSTR_FLUSH_MODE_NONE}) {
+        const std::string file_name = "log\\test\\TestToStrPrint_FlushMode.txt";
+
+        ToStr_SetPrintFlushMode(flush_mode, 16);
+
+        FILE* file = nullptr;
+        TTK_ASSERT(fopen_s(&file, file_name.c_str(), "wb") == 0 && file);
+
+        std::string expected_content;
+        for (int index = 0; index < 100; ++index) {
+            TTK_ASSERT(ToStrPrint(file, "line %d\n", index));
+            expected_content += ToStr("line %d\n", index);
+        }
+
+        fclose(file);
+
+        TTK_ASSERT(LoadTextFromFileUTF8(file_name) == expected_content);
+    }
+
+    // batched flush mode, printing to two files by turns
+    {
+        const std::string file_names[] = {"log\\test\\TestToStrPrint_BatchedA.txt", "log\\test\\TestToStrPrint_BatchedB.txt"};
+
+        ToStr_SetPrintFlushMode(TOSTR_FLUSH_MODE_BATCHED, 16);
+
+        FILE* files[2] = {};
+        TTK_ASSERT(fopen_s(&files[0], file_names[0].c_str(), "wb") == 0 && files[0]);
+        TTK_ASSERT(fopen_s(&files[1], file_names[1].c_str(), "wb") == 0 && files[1]);
+
+        std::string expected_content;
+        for (int index = 0; index < 10; ++index) {
+            TTK_ASSERT(ToStrPrint(files[0], "line %d\n", index));
+            TTK_ASSERT(ToStrPrint(files[1], "line %d\n", index));
+
+            // each file is flushed after every third line (7 bytes each)
+            if (index < 9) expected_content += ToStr("line %d\n", index);
+        }
+
+        TTK_ASSERT(LoadTextFromFileUTF8(file_names[0]) == expected_content);
+        TTK_ASSERT(LoadTextFromFileUTF8(file_names[1]) == expected_content);
+
+        fclose(files[0]);
+        fclose(files[1]);
+
+        ToStr_SetPrintFlushMode(TOSTR_FLUSH_MODE_NONE);
+    }
+
+    // wide file (unicode translation mode)
+    {
+        const std::string file_name = "log\\test\\TestToStrPrint_Wide.txt";
+
+        FILE* file = nullptr;
+        TTK_ASSERT(fopen_s(&file, file_name.c_str(), "wb") == 0 && file);
+        TTK_ASSERT(_setmode(_fileno(file), _O_U16TEXT) != -1);
+
+        TTK_ASSERT(ToStrPrint(file, u8"%s \u0444%d", "text", 123));
+        TTK_ASSERT(ToStrPrint(file, u8"\U00020001"));
+
+        fclose(file);
+
+        const std::wstring expected_text = L"text \u0444" L"123" + ToUTF16(u8"\U00020001");
+
+        TTK_ASSERT(InnerLoadBinaryContentFromFile(file_name) == std::string((const char*)expected_text.data(), expected_text.length() * sizeof(wchar_t)));
+    }
+
+    // many threads, lines do not interleave
+    {
+        const std::string file_name = "log\\test\\TestToStrPrint_Threads.txt";
+        const std::string line(100, 'x');
+
+        FILE* file = nullptr;
+        TTK_ASSERT(fopen_s(&file, file_name.c_str(), "wb") == 0 && file);
+
+        std::vector<std::thread> threads;
+        for (int index = 0; index < 4; ++index) {
+            threads.emplace_back([file, &line]() {
+                for (int index = 0; index < 100; ++index) ToStrPrint(file, "%s\n", line.c_str());
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        fclose(file);
+
+        const std::string content = LoadTextFromFileUTF8(file_name);
+        const LineIndex line_index(content);
+
+        TTK_ASSERT(line_index.GetLineCount() == 400);
+        for (size_t index = 0; index < line_index.GetLineCount(); ++index) TTK_ASSERT(line_index.GetLine(index) == line);
+    }
+}
+
+void TestToHexStr() {
+    // empty
+    TTK_ASSERT(ToHexStr("") == "");
+    TTK_ASSERT(ToHexStr(nullptr, 0) == "");
+
+    // bytes
+    {
+        const unsigned char data[] = { 0x00, 0x01, 0x7F, 0x80, 0xA1, 0xFF };
+        TTK_ASSERT(ToHexStr(data, sizeof(data)) == "00017F80A1FF");
+    }
+
+    // long data
+    {
+        std::string data;
+        std::string expected_text;
+
+        for (size_t index = 0; index < 1000; ++index) {
+            data += char(index);
+            expected_text += ToStr("%02X", (unsigned char)index);
+        }
+
+        TTK_ASSERT(ToHexStr(data) == expected_text);
+    }
+
+    // append
+    {
+        std::string text = "data: ";
+        AppendHexStr(text, "\x12\xAB", 2);
+        TTK_ASSERT(text == "data: 12AB");
+    }
+}
+
+void TestToJSONEscaped() {
+    TTK_ASSERT(ToJSONEscaped("") == "");
+    TTK_ASSERT(ToJSONEscaped("Some text.") == "Some text.");
+    TTK_ASSERT(ToJSONEscaped(u8"Some text \u0444.") == u8"Some text \u0444.");
+    TTK_ASSERT(ToJSONEscaped("\"quote\" \\ \b\f\n\r\t") == "\\\"quote\\\" \\\\ \\b\\f\\n\\r\\t");
+    TTK_ASSERT(ToJSONEscaped(std::string("\x01\x1F\0\x7F", 4)) == "\\u0001\\u001f\\u0000\x7F");
+
+    // long text
+    {
+        std::string text;
+        std::string expected_text;
+
+        for (size_t index = 0; index < 100; ++index) {
+            text += "Some text, \"quoted\".\n";
+            expected_text += "Some text, \\\"quoted\\\".\\n";
+        }
+
+        TTK_ASSERT(ToJSONEscaped(text) == expected_text);
+    }
+
+    // append
+    {
+        std::string text = "{\"key\": \"";
+        AppendJSONEscaped(text, "a\"b");
+        text += "\"}";
+        TTK_ASSERT(text == "{\"key\": \"a\\\"b\"}");
+    }
+}
+
+void TestToCEscaped() {
+    TTK_ASSERT(ToCEscaped("") == "");
+    TTK_ASSERT(ToCEscaped("Some text.") == "Some text.");
+    TTK_ASSERT(ToCEscaped(u8"Some text \u0444.") == u8"Some text \u0444.");
+    TTK_ASSERT(ToCEscaped("\"quote\" \\ \a\b\f\n\r\t\v") == "\\\"quote\\\" \\\\ \\a\\b\\f\\n\\r\\t\\v");
+    TTK_ASSERT(ToCEscaped(std::string("\x01" "1\x1F\0\x7F", 5)) == "\\0011\\037\\000\\177");
+
+    // append
+    {
+        std::string text = "const char* text = \"";
+        AppendCEscaped(text, "line\n");
+        text += "\";";
+        TTK_ASSERT(text == "const char* text = \"line\\n\";");
+    }
+}
+
+void TestFromStr() {
+    bool is_parsed = false;
+
+    // integers
+    TTK_ASSERT(FromStr<int>("0", &is_parsed) == 0 && is_parsed);
+    TTK_ASSERT(FromStr<int>("-123", &is_parsed) == -123 && is_parsed);
+    TTK_ASSERT(FromStr<int>("+123", &is_parsed) == 123 && is_parsed);
+    TTK_ASSERT(FromStr<int>("2147483647", &is_parsed) == 2147483647 && is_parsed);
+    TTK_ASSERT(FromStr<long long>("-9223372036854775808", &is_parsed) == (std::numeric_limits<long long>::min)() && is_parsed);
+    TTK_ASSERT(FromStr<unsigned long long>("18446744073709551615", &is_parsed) == (std::numeric_limits<unsigned long long>::max)() && is_parsed);
+
+    // floating points
+    TTK_ASSERT(FromStr<double>("3.14", &is_parsed) == 3.14 && is_parsed);
+    TTK_ASSERT(FromStr<double>("-.5", &is_parsed) == -0.5 && is_parsed);
+    TTK_ASSERT(FromStr<double>("1e-3", &is_parsed) == 0.001 && is_parsed);
+    TTK_ASSERT(FromStr<double>("0.1234567890123456789012345", &is_parsed) == 0.1234567890123456789012345 && is_parsed);
+    TTK_ASSERT(FromStr<double>("123456789012345678901234567890", &is_parsed) == 123456789012345678901234567890.0 && is_parsed);
+    TTK_ASSERT(FromStr<float>("3.14", &is_parsed) == 3.14f && is_parsed);
+    TTK_ASSERT(FromStr<double>("inf", &is_parsed) == std::numeric_limits<double>::infinity() && is_parsed);
+
+    // wrong text
+    TTK_ASSERT(FromStr<int>("", &is_parsed) == 0 && !is_parsed);
+    TTK_ASSERT(FromStr<int>(" 1", &is_parsed) == 0 && !is_parsed);
+    TTK_ASSERT(FromStr<int>("1 ", &is_parsed) == 0 && !is_parsed);
+    TTK_ASSERT(FromStr<int>("12a", &is_parsed) == 0 && !is_parsed);
+    TTK_ASSERT(FromStr<int>("2147483648", &is_parsed) == 0 && !is_parsed);  // overflow
+    TTK_ASSERT(FromStr<unsigned>("-1", &is_parsed) == 0 && !is_parsed);
+    TTK_ASSERT(FromStr<double>("1e", &is_parsed) == 0 && !is_parsed);
+    TTK_ASSERT(FromStr<double>("0x10", &is_parsed) == 0 && !is_parsed);
+    TTK_ASSERT(FromStr<double>("1e400", &is_parsed) == 0 && !is_parsed);   // out of range
+
+    // no is_parsed check
+    TTK_ASSERT(FromStr<int>("42") == 42);
+
+    // parsing from beginning of text
+    {
+        const std::string text = "12.5;rest";
+
+        double value = 0;
+        const char* end = FromStr(text.data(), text.data() + text.size(), value);
+
+        TTK_ASSERT(value == 12.5);
+        TTK_ASSERT(std::string(end) == ";rest");
+    }
+
+    // round trip with ToStr
+    {
+        std::mt19937_64 generator(1);
+
+        for (size_t index = 0; index < 10000; ++index) {
+            const long long integer = (long long)generator() >> (generator() % 64);
+            TTK_ASSERT(FromStr<long long>(ToStr("%lld", integer)) == integer);
+
+            const double number = std::ldexp(double(generator() >> 11), int(generator() % 200) - 100) * ((generator() & 1) ? 1 : -1);
+            TTK_ASSERT(FromStr<double>(ToStr("%.17g", number)) == number);
+
+            const float small_number = float(number);
+            TTK_ASSERT(FromStr<float>(ToStr("%.9g", small_number)) == small_number);
+
+            const double fixed_point_number = FromStr<double>(ToStr("%.3f", number));
+            TTK_ASSERT(ToStr("%.3f", fixed_point_number) == ToStr("%.3f", number));
+        }
+    }
+}
+
+void TestFromStrColumns() {
+    // columns
+    {
+        std::vector<int>        ids;
+        std::vector<double>     values;
+        std::vector<unsigned>   counts;
+
+        TTK_ASSERT(FromStrColumns("1,2.5,3\r\n\n-4,1e3,5\n", ',', ids, values, counts));
+
+        TTK_ASSERT(ids == std::vector<int>({1, -4}));
+        TTK_ASSERT(values == std::vector<double>({2.5, 1000.0}));
+        TTK_ASSERT(counts == std::vector<unsigned>({3, 5}));
+    }
+
+    // round trip with ToStr
+    {
+        std::string text;
+        for (int index = 0; index < 1000; ++index) text += ToStr("%d\t%.17g\n", index, index / 7.0);
+
+        std::vector<int>        ids;
+        std::vector<double>     values;
+
+        TTK_ASSERT(FromStrColumns(text, '\t', ids, values));
+        TTK_ASSERT(ids.size() == 1000 && values.size() == 1000);
+
+        for (int index = 0; index < 1000; ++index) {
+            TTK_ASSERT(ids[index] == index);
+            TTK_ASSERT(values[index] == index / 7.0);
+        }
+    }
+
+    // wrong rows
+    {
+        std::vector<int>        ids;
+        std::vector<double>     values;
+
+        TTK_ASSERT(!FromStrColumns("1,2\n3\n4,5\n", ',', ids, values)); // not enough numbers
+        TTK_ASSERT(ids == std::vector<int>({1}));
+        TTK_ASSERT(values == std::vector<double>({2}));
+
+        TTK_ASSERT(!FromStrColumns("1,2,3\n", ',', ids, values)); // too many numbers
+        TTK_ASSERT(!FromStrColumns("1,x\n", ',', ids, values));
+        TTK_ASSERT(ids.size() == 1 && values.size() == 1);
+    }
+}
+
+void TestToStrRows() {
+    // csv
+    {
+        const std::vector<int>              ids     = {1, -20, 300, 0, (std::numeric_limits<int>::min)()};
+        const std::vector<double>           values  = {1.5, -0.25, 1234.5678, 0.0, -0.0001};
+        const std::vector<std::string>      names   = {"one", "two", "", u8"\u0444our", "five"};
+
+        TTK_ASSERT(ToStrRows("%d,%.3f,%s\n", ids, values, names) == 
+            "1,1.500,one\n"
+            "-20,-0.250,two\n"
+            "300,1234.568,\n"
+            u8"0,0.000,\u0444our\n"
+            "-2147483648,-0.000,five\n");
+
+        TTK_ASSERT(ToStrRows("%d\t%f\t\"%s\"\r\n", ids, values, names) == 
+            "1\t1.500000\t\"one\"\r\n"
+            "-20\t-0.250000\t\"two\"\r\n"
+            "300\t1234.567800\t\"\"\r\n"
+            u8"0\t0.000000\t\"\u0444our\"\r\n"
+            "-2147483648\t-0.000100\t\"five\"\r\n");
+    }
+
+    // empty columns
+    {
+        TTK_ASSERT(ToStrRows("%d,%s\n", std::vector<int>(), std::vector<std::string>()) == "");
+    }
+
+    // types of columns, length modifiers are ignored
+    {
+        const std::vector<int8_t>               a = {-128, 127};
+        const std::vector<uint16_t>             b = {0, 65535};
+        const std::vector<int64_t>              c = {(std::numeric_limits<int64_t>::min)(), (std::numeric_limits<int64_t>::max)()};
+        const std::vector<uint64_t>             d = {0, (std::numeric_limits<uint64_t>::max)()};
+        const std::vector<float>                e = {0.5f, -2.75f};
+        const std::vector<std::string_view>     f = {"ab", "cd"};
+        const std::vector<const char*>          g = {"ef", "gh"};
+
+        TTK_ASSERT(ToStrRows("%hhd %d %lld %llu %.1f %s %s;", a, b, c, d, e, f, g) == 
+            "-128 0 -9223372036854775808 0 0.5 ab ef;"
+            "127 65535 9223372036854775807 18446744073709551615 -2.8 cd gh;");
+
+        // value of unsigned column is never negative
+        TTK_ASSERT(ToStrRows("%d;", d) == "0;18446744073709551615;");
+
+        // signed column with unsigned conversion, value is promoted to int (as by 'printf')
+        TTK_ASSERT(ToStrRows("%x %u;", a, a) == "ffffff80 4294967168;7f 127;");
+        TTK_ASSERT(ToStrRows("%x %u;", a, a) == ToStr("%x %u;", a[0], a[0]) + ToStr("%x %u;", a[1], a[1]));
+        TTK_ASSERT(ToStrRows("%llx;", c) == "8000000000000000;7fffffffffffffff;");
+
+        // characters from columns of different types
+        const std::vector<unsigned char>    h = {'a', 0xE9};
+        const std::vector<uint16_t>         i = {'b', 'c'};
+        const std::vector<char>             j = {'d', char(0xE9)};
+
+        TTK_ASSERT(ToStrRows("%c%c%c;", h, i, j) == "abd;\xE9" "c\xE9;");
+    }
+
+    // flags, width and precision
+    {
+        const std::vector<int>          a = {42, -7};
+        const std::vector<double>       b = {3.14159, -1e10};
+        const std::vector<std::string>  c = {"abcdef", "x"};
+        const std::vector<int>          d = {'A', 'z'};
+
+        TTK_ASSERT(ToStrRows("[%05d|%-4d|%+.2e|%8.3f|%-7s|%.3s|%c|%%]", a, a, b, b, c, c, d) == 
+            ToStr("[%05d|%-4d|%+.2e|%8.3f|%-7s|%.3s|%c|%%]", 42, 42, 3.14159, 3.14159, "abcdef", "abcdef", 'A') +
+            ToStr("[%05d|%-4d|%+.2e|%8.3f|%-7s|%.3s|%c|%%]", -7, -7, -1e10, -1e10, "x", "x", 'z'));
+    }
+
+    // floating point numbers, the same as from 'snprintf'
+    {
+        std::mt19937_64 generator(1234);
+        std::uniform_real_distribution<double>  distribution(-1e6, 1e6);
+        std::uniform_int_distribution<int>      exponent_distribution(-12, 12);
+
+        std::vector<double> values = {
+            0.0, -0.0, 0.5, 1.5, 2.5, 0.125, 0.375, 1e-10, -1e-10, 0.05, 0.15, 0.25, 0.35, 
+            999999.9999999, 1e12, 1e15, 1e300, -1e300, 
+            std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::quiet_NaN(), 
+            (std::numeric_limits<double>::min)(), std::numeric_limits<double>::denorm_min(), 
+        };
+        for (size_t index = 0; index < 2000; ++index) {
+            values.push_back(distribution(generator) * pow(10.0, exponent_distribution(generator)));
+        }
+
+        for (int precision = 0; precision <= 10; ++precision) {
+            const std::string format = "%." + std::to_string(precision) + "f\n";
+
+            std::string expected;
+            for (double value : values) expected += ToStr(format, value);
+
+            TTK_ASSERT(ToStrRows(format.c_str(), values) == expected);
+        }
+
+        std::string expected;
+        for (double value : values) expected += ToStr("%f,", value);
+
+        TTK_ASSERT(ToStrRows("%f,", values) == expected);
+    }
+
+    // threads
+    {
+        std::vector<int>            ids;
+        std::vector<double>         values;
+        std::vector<std::string>    names;
+
+        for (int index = 0; index < 100000; ++index) {
+            ids.push_back(index * 7 - 1000);
+            values.push_back(index / 8.0);
+            names.push_back("name" + std::to_string(index % 13));
+        }
+
+        const std::string expected = ToStrRows("%d,%.2f,%s\n", ids, values, names);
+
+        TTK_ASSERT(ToStrRows(0, "%d,%.2f,%s\n", ids, values, names) == expected);
+        TTK_ASSERT(ToStrRows(3, "%d,%.2f,%s\n", ids, values, names) == expected);
+        TTK_ASSERT(ToStrRows(64, "%d,%.2f,%s\n", ids, values, names) == expected);
+
+        std::string expected_rows;
+        for (size_t index = 0; index < 1000; ++index) expected_rows += ToStr("%d,%.2f,%s\n", ids[index], values[index], names[index].c_str());
+
+        TTK_ASSERT(expected.compare(0, expected_rows.length(), expected_rows) == 0);
+
+        // print
+        TTK_ASSERT(CreateDirectoryA(".\\log", 0) || GetLastError() == ERROR_ALREADY_EXISTS);
+        TTK_ASSERT(CreateDirectoryA(".\\log\\test", 0) || GetLastError() == ERROR_ALREADY_EXISTS);
+
+        const std::string file_name = "log\\test\\TestToStrRows.csv";
+
+        FILE* file = nullptr;
+        TTK_ASSERT(fopen_s(&file, file_name.c_str(), "wb") == 0 && file);
+
+        TTK_ASSERT(ToStrPrintRows(file, "%d,%.2f,%s\n", ids, values, names));
+        fclose(file);
+
+        TTK_ASSERT(InnerLoadBinaryContentFromFile(file_name) == expected);
+    }
+}
+
 void TestToStrFATAL_ERRROR() {
     TTK_ASSERT(CreateDirectoryA(".\\log", 0) || GetLastError() == ERROR_ALREADY_EXISTS);
     TTK_ASSERT(CreateDirectoryA(".\\log\\test", 0) || GetLastError() == ERROR_ALREADY_EXISTS);
@@ -487,6 +1669,11 @@ void TestToStrFATAL_ERRROR() {
 
     system("ToStr_Test.exe CUSTOM_ERR_MSG_HANDLING > log\\test\\custom_err_msg_handling.txt");
     TTK_ASSERT(InnerLoadContentFromFile("log\\test\\custom_err_msg_handling.txt") == "ToStr Error: Argument 'text' can not be 0 or nullptr.\naddition text\n");
+
+#ifdef TOSTR_SHARED_FORMAT
+    system("ToStr_Test.exe ARGUMENTS_NOT_MATCHING_FORMAT > log\\test\\arguments_not_matching_format.txt");
+    TTK_ASSERT(InnerLoadContentFromFile("log\\test\\arguments_not_matching_format.txt") == "ToStr Error: Arguments do not match format.\n");
+#endif
 }
 
 //------------------------------------------------------------------------------
@@ -521,11 +1708,31 @@ int ToStr_RunTests(int argc, char *argv[]) {
 
         return false;
 
+    } else if (IsFlag("ARGUMENTS_NOT_MATCHING_FORMAT")) {
+        ToStr("%d %d", 4); // this function will exit with error code
+        return false;
+
     } else {
         TTK_ADD_TEST(TestToUTF8, 0);
         TTK_ADD_TEST(TestToUTF16, 0);
+        TTK_ADD_TEST(TestToUTF32, 0);
+        TTK_ADD_TEST(TestLatin1, 0);
         TTK_ADD_TEST(TestLoadSave, 0);
+        TTK_ADD_TEST(TestSaveUTF16, 0);
+        TTK_ADD_TEST(TestLoadTextFromFiles, 0);
+        TTK_ADD_TEST(TestTextFileCache, 0);
+        TTK_ADD_TEST(TestLineIndex, 0);
         TTK_ADD_TEST(TestToStr, 0);
+        TTK_ADD_TEST(TestToStrArguments, 0);
+        TTK_ADD_TEST(TestToStrFixed, 0);
+        TTK_ADD_TEST(TestToStrBuilder, 0);
+        TTK_ADD_TEST(TestToStrPrint, 0);
+        TTK_ADD_TEST(TestToHexStr, 0);
+        TTK_ADD_TEST(TestToJSONEscaped, 0);
+        TTK_ADD_TEST(TestToCEscaped, 0);
+        TTK_ADD_TEST(TestFromStr, 0);
+        TTK_ADD_TEST(TestFromStrColumns, 0);
+        TTK_ADD_TEST(TestToStrRows, 0);
         TTK_ADD_TEST(TestToStrFATAL_ERRROR, 0);
 
         return !TTK_Run();
@@ -34,9 +34,34 @@
 #include <windows.h>
 #include <locale.h>
 #include <wchar.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <float.h>
+#include <io.h>
+#include <fcntl.h>
 
 #include <string>
+#include <string_view>
 #include <utility>
+#include <algorithm>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <list>
+#include <unordered_map>
+#include <tuple>
+#include <type_traits>
+#include <limits>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TOSTR_SSE2
+#include <emmintrin.h>
+#endif
 
 //------------------------------------------------------------------------------
 // Declarations
@@ -50,6 +75,35 @@ std::string ToUTF8(const std::wstring& text_utf16);
 // Invalid unicode will be replaced with 'FFFD' code.
 std::wstring ToUTF16(const std::string& text_utf8);
 
+// Converts utf8 string to utf32 string.
+// Invalid unicode will be replaced with 'FFFD' code.
+std::u32string ToUTF32(const std::string& text_utf8);
+void ToUTF32(const std::string& text_utf8, std::u32string& text_utf32); // reuses memory of 'text_utf32'
+
+// Converts utf16 string to utf32 string.
+// Invalid unicode will be replaced with 'FFFD' code.
+std::u32string ToUTF32(const std::wstring& text_utf16);
+void ToUTF32(const std::wstring& text_utf16, std::u32string& text_utf32); // reuses memory of 'text_utf32'
+
+// Converts utf32 string to utf8 string.
+// Invalid unicode will be replaced with 'EF BF BD' code sequence.
+std::string ToUTF8(const std::u32string& text_utf32);
+void ToUTF8(const std::u32string& text_utf32, std::string& text_utf8); // reuses memory of 'text_utf8'
+
+// Converts utf32 string to utf16 string.
+// Invalid unicode will be replaced with 'FFFD' code.
+std::wstring ToUTF16(const std::u32string& text_utf32);
+void ToUTF16(const std::u32string& text_utf32, std::wstring& text_utf16); // reuses memory of 'text_utf16'
+
+// Converts latin1 (ISO-8859-1) string to utf8 string.
+std::string Latin1ToUTF8(const std::string& text_latin1);
+void Latin1ToUTF8(const std::string& text_latin1, std::string& text_utf8); // reuses memory of 'text_utf8'
+
+// Converts utf8 string to latin1 (ISO-8859-1) string.
+// Invalid unicode and characters which are not in latin1 will be replaced with '?'.
+std::string ToLatin1(const std::string& text_utf8);
+void ToLatin1(const std::string& text_utf8, std::string& text_latin1); // reuses memory of 'text_latin1'
+
 //------------------------------------------------------------------------------
 
 // This is the size for internal buffer placed in stack region of memory. 
@@ -57,6 +111,14 @@ std::wstring ToUTF16(const std::string& text_utf8);
 // If there is need for bigger one, then dynamically allocated buffer is created temporary.
 enum { TOSTR_MIN_BUFFER_SIZE = 4096 };
 
+// Functions placed below, which take format and arguments (ToStr, ToStrFixed, ToStrBuilder::Append, ToStrPrint), pass arguments 
+// directly to 'snprintf'.
+// If TOSTR_SHARED_FORMAT is defined before including this header, then they pack arguments and pass them to one shared 
+// formatting function instead, so each distinct set of argument types generates only a little code (at cost of slower formatting).
+// Then arguments can be numbers, enumerations, pointers and c strings (as 'const char*' or 'const wchar_t*'), 
+// and arguments which do not match format (not enough of them, or of wrong type, for example integer for '%f') 
+// are reported as fatal error "<function> Error: Arguments do not match format." (see ToStr_SetHandleFatalErrorMessageFunction).
+
 // Converts arguments to text according to the format. Encoding of strings: ASCII, UTF8.
 // format           Same rules as for 'printf' function.
 // arguments        Same rules as for 'printf' function.
@@ -71,6 +133,133 @@ std::string ToStr(const char* format, Types&&... arguments);
 template <typename... Types>
 std::string ToStr(const std::string& format, Types&&... arguments);
 
+// String with fixed capacity. Text is stored inside of object, so it never allocates memory dynamically. Trivially copyable.
+// Text which does not fit is truncated (without breaking utf8 sequences) and the truncation is reported by IsTruncated.
+// Converts to std::string_view and std::string, so can be passed to other functions from this lib.
+template <size_t CAPACITY>
+class FixedString {
+public:
+    FixedString();
+
+    // text                 Text to be copied. Truncated, if longer than capacity. Encoding: ASCII or UTF8.
+    explicit FixedString(std::string_view text);
+
+    // Formats text into object. Same rules as for ToStr function.
+    // Returns              true    - if entire text fit,
+    //                      false   - otherwise (text is truncated).
+    template <typename... Types>
+    bool Format(const char* format, Types&&... arguments);
+
+    const char* ToCStr() const;
+    size_t GetLength() const;
+    bool IsEmpty() const;
+    bool IsTruncated() const;
+
+    static constexpr size_t GetCapacity() { return CAPACITY; }
+
+    operator std::string_view() const;
+    operator std::string() const;
+
+private:
+    void SetLength(size_t length);
+
+    char        m_text[CAPACITY + 1];
+    size_t      m_length;
+    bool        m_is_truncated;
+};
+
+// Converts arguments to text according to the format, without dynamic memory allocation. 
+// Text is truncated to CAPACITY bytes, if needed. Encoding of strings: ASCII, UTF8.
+// CAPACITY         Maximal length of text (without terminating null).
+// format           Same rules as for 'printf' function.
+// arguments        Same rules as for 'printf' function.
+template <size_t CAPACITY>
+FixedString<CAPACITY> ToStrFixed(const char* text); // pass through
+
+template <size_t CAPACITY, typename... Types>
+FixedString<CAPACITY> ToStrFixed(const char* format, Types&&... arguments);
+
+// Builds text from many parts, without concatenating them. Parts are stored one after another in chunks of memory.
+// Entire text is put together only once (by ToString), or is written directly to file without putting it together.
+class ToStrBuilder {
+public:
+    enum { DEFAULT_CHUNK_SIZE = 64 * 1024 };
+
+    // chunk_size           (Optional) Size of memory chunk in bytes. Parts longer than chunk size get chunk of their own.
+    explicit ToStrBuilder(size_t chunk_size = DEFAULT_CHUNK_SIZE);
+
+    // Appends arguments converted to text according to the format. Same rules as for ToStr function.
+    template <typename... Types>
+    ToStrBuilder& Append(const char* format, Types&&... arguments);
+
+    ToStrBuilder& Append(const char* text);         // pass through
+    ToStrBuilder& Append(const std::string& text);  // pass through
+    ToStrBuilder& Append(std::string_view text);    // pass through
+
+    // Returns              Total length of text.
+    size_t GetLength() const;
+    bool IsEmpty() const;
+
+    void Clear();
+
+    // Returns              Entire text, put together.
+    std::string ToString() const;
+
+    // Writes entire text to file, without putting it together.
+    // file                 Opened file (or stream) in binary mode.
+    // Returns              true    - if entire text has been written,
+    //                      false   - otherwise.
+    bool WriteToFile(FILE* file) const;
+
+private:
+    template <typename Formatter>
+    ToStrBuilder& AppendFormatted(const char* format, const Formatter& formatter);
+
+    struct Chunk {
+        std::unique_ptr<char[]>     data;
+        size_t                      length;
+        size_t                      capacity;
+    };
+
+    void AddChunk(size_t min_capacity);
+    char* ToEnd();
+    size_t GetFreeSize() const;
+
+    std::vector<Chunk>  m_chunks;
+    size_t              m_chunk_size;
+    size_t              m_length;
+};
+
+// Prints arguments converted to text according to the format to file (or stream), for example to stdout.
+// Text is formatted in buffer on stack (dynamic memory is allocated only for text longer than TOSTR_MIN_BUFFER_SIZE),
+// then written under one lock of the file, so texts printed from different threads do not interleave.
+// If file is in unicode translation mode (_O_U16TEXT, _O_U8TEXT or _O_WTEXT, see '_setmode') or is wide oriented (see 'fwide'), 
+// then text is converted from utf8 to utf16 before writing.
+// file             Opened file or stream.
+// format           Same rules as for 'printf' function.
+// arguments        Same rules as for 'printf' function.
+// Returns          true    - if entire text has been written,
+//                  false   - otherwise.
+template <typename... Types>
+bool ToStrPrint(FILE* file, const char* format, Types&&... arguments);
+
+bool ToStrPrint(FILE* file, const char* text); // pass through
+
+bool ToStrPrint(FILE* file, const std::string& text); // pass through
+
+enum ToStr_FlushMode {
+    TOSTR_FLUSH_MODE_NONE,      // file is flushed according to its buffering (default)
+    TOSTR_FLUSH_MODE_EACH,      // file is flushed after each ToStrPrint call
+    TOSTR_FLUSH_MODE_BATCHED,   // file is flushed when at least batch size bytes have been printed to it (by calling thread) since last flush,
+                                // counted separately for each file
+};
+
+enum { TOSTR_DEFAULT_FLUSH_BATCH_SIZE = 64 * 1024 };
+
+// Sets when ToStrPrint flushes file.
+// batch_size       (Optional) Number of bytes for TOSTR_FLUSH_MODE_BATCHED.
+void ToStr_SetPrintFlushMode(ToStr_FlushMode flush_mode, size_t batch_size = TOSTR_DEFAULT_FLUSH_BATCH_SIZE); // not multi-thread safe
+
 // Replaces default function for handling error messages to custom, used by ToStr function. 
 // After handling error message, ToStr function aborts execution of calling program.
 void ToStr_SetHandleFatalErrorMessageFunction(void (*handle_fatal_error_message)(const char* message)); // not multi-thread safe
@@ -79,6 +268,83 @@ void ToStr_DefaultHandleFatalErrorMessage(const char* message);
 
 //------------------------------------------------------------------------------
 
+// Converts bytes to text with two upper case hexadecimal digits per byte (for example: "00A1FF").
+// data             Bytes to be converted.
+// size             Number of bytes.
+std::string ToHexStr(const void* data, size_t size);
+std::string ToHexStr(std::string_view data);
+void AppendHexStr(std::string& text, const void* data, size_t size); // appends to 'text'
+
+// Escapes text, so it can be placed between quotes of JSON string. 
+// Escapes '"', '\' and control characters. Other characters (including utf8 sequences) are copied as they are.
+std::string ToJSONEscaped(std::string_view text);
+void AppendJSONEscaped(std::string& text, std::string_view text_to_escape); // appends to 'text'
+
+// Escapes text, so it can be placed between quotes of C/C++ string literal. 
+// Escapes '"', '\' and control characters (with octal escape sequence, if there is no short one). 
+// Other characters (including utf8 sequences) are copied as they are.
+std::string ToCEscaped(std::string_view text);
+void AppendCEscaped(std::string& text, std::string_view text_to_escape); // appends to 'text'
+
+//------------------------------------------------------------------------------
+
+// Parses number from text. Never depends on locale (decimal point is always '.').
+// Integer:         [+|-]digits
+// Floating point:  [+|-]digits[.digits][(e|E)[+|-]digits], also "inf", "infinity", "nan" (as for 'strtod').
+// Type             Any integer type (except bool), float or double.
+// text             Text containing only the number (no white spaces).
+// is_parsed        (Optional) If entire text is a number which fits into Type - sets to true, otherwise - sets to false.
+// Returns          Parsed number, or 0 if text could not be parsed.
+template <typename Type>
+Type FromStr(std::string_view text, bool* is_parsed = nullptr);
+
+// Parses number from beginning of text. Same rules as above.
+// begin            Beginning of text.
+// end              End of text (text does not need to be null terminated).
+// value            Parsed number. Not changed, if text could not be parsed.
+// Returns          Pointer to the first character after parsed number, 
+//                  or 'begin' if there is no number at beginning of text or the number does not fit into Type.
+template <typename Type>
+const char* FromStr(const char* begin, const char* end, Type& value);
+
+// Parses numbers from rows of text into columns. Each row (line) contains one number for each column, separated by delimiter.
+// Empty lines are skipped. Lines may end with "\r\n".
+// text             Text with rows. For example: "1,2.5\n3,4.5\n".
+// delimiter        Character which separates numbers in row. For example: ',' or '\t'.
+// columns          Vectors to which parsed numbers are appended (the first number from each row goes to the first column, and so on).
+// Returns          true    - if all rows have been parsed,
+//                  false   - otherwise (columns contain numbers only from rows before invalid one).
+template <typename... Types>
+bool FromStrColumns(std::string_view text, char delimiter, std::vector<Types>&... columns);
+
+// Converts rows of columns to text according to the format, for example to CSV or TSV text.
+// Format is parsed only once, then it is applied to each row (the first conversion specification takes value from the first column, and so on).
+// Integers and strings without flags, width and precision, and floating point numbers with '%f' (precision up to 9) are converted 
+// without calling 'snprintf'. Length modifiers in format are not needed and are ignored (each value is converted with type of its column).
+// format           Format of one row, with one conversion specification for each column. For example: "%d,%.3f,%s\n". 
+//                  Same rules as for 'printf' function, except that width and precision can not be given as '*'.
+// columns          Vectors with values. All must have the same size. Type of values: any integer type (except bool), float, double, 
+//                  std::string, std::string_view or const char*. 
+// Returns          Text of all rows. Encoding of strings: ASCII, UTF8.
+template <typename... Types>
+std::string ToStrRows(const char* format, const std::vector<Types>&... columns);
+
+// Converts rows of columns to text, as above. Rows are split into ranges, which are converted in parallel by many threads.
+// Text of ranges is put together in order of rows.
+// thread_count     Number of threads. If 0, then number of hardware threads is used.
+template <typename... Types>
+std::string ToStrRows(unsigned thread_count, const char* format, const std::vector<Types>&... columns);
+
+// Converts rows of columns to text, as above, and prints it to file (or stream). 
+// Text is printed in parts of many rows (with ToStrPrint rules), so text of all rows is never kept in memory at once.
+// file             Opened file or stream.
+// Returns          true    - if entire text has been written,
+//                  false   - otherwise.
+template <typename... Types>
+bool ToStrPrintRows(FILE* file, const char* format, const std::vector<Types>&... columns);
+
+//------------------------------------------------------------------------------
+
 // Loads text from file.
 // file_name            File name with full path to file. Encoding: ASCII.
 // is_loaded            (Optional) If entire file text has been loaded - sets to true, otherwise - sets to false.
@@ -98,6 +364,138 @@ std::string LoadTextFromFileUTF8(const std::string& file_name, bool* is_loaded =
 // Returns              Loaded text. Encoding: ASCII or UTF8.
 std::string LoadTextFromFileUTF8_BOM(const std::string& file_name, bool* is_loaded = nullptr);
 
+// Selects which of above loading functions is used for each file by LoadTextFromFiles.
+enum ToStr_LoadMode {
+    TOSTR_LOAD_MODE_ASCII,      // as LoadTextFromFile
+    TOSTR_LOAD_MODE_UTF8,       // as LoadTextFromFileUTF8
+    TOSTR_LOAD_MODE_UTF8_BOM,   // as LoadTextFromFileUTF8_BOM
+};
+
+struct LoadedTextFile {
+    std::string     text;       // Loaded text. Encoding: ASCII or UTF8.
+    bool            is_loaded;  // If entire file text has been loaded - true, otherwise - false.
+};
+
+// Loads texts from many files at once. Files are loaded in parallel by a pool of threads.
+// file_names           File names with full paths to files. Encoding: ASCII or UTF8 (only ASCII for TOSTR_LOAD_MODE_ASCII).
+// mode                 (Optional) Decides how each file is loaded (carriage return suppression, BOM handling).
+// thread_count         (Optional) Number of loading threads. If 0, then number of hardware threads is used.
+// Returns              Loaded texts together with loading status, in the same order as file names.
+std::vector<LoadedTextFile> LoadTextFromFiles(const std::vector<std::string>& file_names, ToStr_LoadMode mode = TOSTR_LOAD_MODE_UTF8, unsigned thread_count = 0);
+
+// Cache of texts loaded from files. Loaded texts are shared between callers instead of being copied.
+// Before cached text is returned, size and last write time of file are checked. If any of them changed, then file is loaded again.
+// When total size of cached texts exceeds byte budget, then least recently used texts are evicted.
+// Concurrent loads of the same file are coalesced into one read. Multi-thread safe.
+class TextFileCache {
+public:
+    enum { DEFAULT_BYTE_BUDGET = 64 * 1024 * 1024 };
+
+    // byte_budget          (Optional) Maximal total size of cached texts in bytes.
+    // mode                 (Optional) Decides how each file is loaded (carriage return suppression, BOM handling).
+    explicit TextFileCache(size_t byte_budget = DEFAULT_BYTE_BUDGET, ToStr_LoadMode mode = TOSTR_LOAD_MODE_UTF8);
+    virtual ~TextFileCache() {}
+
+    // Loads text from file or takes it from cache.
+    // file_name            File name with full path to file. Encoding: ASCII or UTF8 (only ASCII for TOSTR_LOAD_MODE_ASCII).
+    // is_loaded            (Optional) If entire file text has been loaded - sets to true, otherwise - sets to false.
+    // Returns              Loaded text, never nullptr. Encoding: ASCII or UTF8.
+    std::shared_ptr<const std::string> Load(const std::string& file_name, bool* is_loaded = nullptr);
+
+    // Removes text of file from cache. Already returned texts stay valid.
+    void Remove(const std::string& file_name);
+
+    // Removes all texts from cache. Already returned texts stay valid.
+    void Clear();
+
+    void SetByteBudget(size_t byte_budget);
+    size_t GetByteBudget() const;
+
+    // Returns              Total size of cached texts in bytes.
+    size_t GetByteSize() const;
+
+private:
+    struct Stamp {
+        bool        is_exist;
+        uint64_t    size;
+        uint64_t    last_write_time;
+
+        bool operator==(const Stamp& other) const;
+    };
+
+    struct Entry {
+        std::string                         file_name;
+        Stamp                               stamp;
+        std::shared_ptr<const std::string>  text;
+        bool                                is_loaded;
+    };
+
+    typedef std::list<Entry> EntryList;
+
+    static Stamp ToStamp(const std::string& file_name);
+
+    void Insert(Entry entry);   // not locking
+    void Evict();               // not locking
+
+    mutable std::mutex                                              m_mutex;
+    EntryList                                                       m_entries;      // most recently used first
+    std::unordered_map<std::string, EntryList::iterator>            m_entry_map;
+    std::unordered_map<std::string, std::shared_future<Entry>>      m_pending_loads;
+    size_t                                                          m_byte_size;
+    size_t                                                          m_byte_budget;
+    ToStr_LoadMode                                                  m_mode;
+};
+
+// Index of line positions in text. Gives access to any line in constant time.
+// Lines are separated by '\n'. Text which ends with '\n' has no empty last line.
+// Indexed text is not copied, so it must outlive the index.
+class LineIndex {
+public:
+    // Range of lines.
+    struct Range {
+        size_t first;   // index of first line
+        size_t count;   // number of lines
+    };
+
+    LineIndex();
+
+    // text                 Text to be indexed. Encoding: ASCII or UTF8.
+    // is_crlf              (Optional) If true, then carriage return (CR) before '\n' is excluded from line.
+    explicit LineIndex(std::string_view text, bool is_crlf = false);
+
+    // Indexes text again. Same parameters as for constructor.
+    void Build(std::string_view text, bool is_crlf = false);
+
+    size_t GetLineCount() const;
+
+    // Returns              Line without line separator.
+    std::string_view GetLine(size_t index) const;
+
+    // Returns              Text of all lines in range, with line separators between them, without last line separator.
+    std::string_view GetText(const Range& range) const;
+
+    // Splits all lines into ranges with similar text size. Useful for processing lines by many threads.
+    // Returns              Ranges in order of lines, no more than range_count. No empty ranges.
+    std::vector<Range> Split(size_t range_count) const;
+
+private:
+    template <typename Offset>
+    static void Scan(std::string_view text, std::vector<Offset>& line_ends);
+
+    size_t GetSeparatorCount() const;
+    size_t GetSeparatorPosition(size_t index) const;
+    size_t FindSeparator(size_t position) const; // index of the first separator at or after position
+    size_t GetLineBegin(size_t index) const;
+    size_t GetLineEnd(size_t index) const; // without carriage return, if is_crlf
+
+    std::string_view        m_text;
+    bool                    m_is_crlf;
+    bool                    m_is_offset64;  // if positions are in m_line_ends64
+    size_t                  m_line_count;
+    std::vector<uint32_t>   m_line_ends32;  // positions of '\n', when text is shorter than 4 GiB
+    std::vector<uint64_t>   m_line_ends64;  // positions of '\n', otherwise
+};
+
 // Saves text to file.
 // file_name            File name with full path to file. Encoding: ASCII.
 // text                 Text to be saved in file. Encoding: ASCII or UTF8.
@@ -106,20 +504,54 @@ std::string LoadTextFromFileUTF8_BOM(const std::string& file_name, bool* is_load
 bool SaveTextToFile(const std::string& file_name, const std::string& text);
 
 
+// Decides how new line characters are saved to file.
+enum ToStr_NewLine {
+    TOSTR_NEW_LINE_LF,      // '\n' is saved as it is
+    TOSTR_NEW_LINE_CRLF,    // '\n' is saved as "\r\n" (unless it is already preceded by '\r')
+};
+
+// Byte order of utf16 code units in file.
+enum ToStr_ByteOrder {
+    TOSTR_BYTE_ORDER_LE,    // little endian
+    TOSTR_BYTE_ORDER_BE,    // big endian
+};
+
 // Saves text to file in UTF8 format.
 // file_name            File name with full path to file. Encoding: ASCII or UTF8.
 // text                 Text to be saved in file. Encoding: ASCII or UTF8.
+// new_line             (Optional) Decides how new line characters are saved.
 // Returns              true    - if entire text has been loaded from file,
 //                      false   - otherwise.
-bool SaveTextToFileUTF8(const std::string& file_name, const std::string& text);
+bool SaveTextToFileUTF8(const std::string& file_name, const std::string& text, ToStr_NewLine new_line = TOSTR_NEW_LINE_LF);
 
 
 // Saves text to file. Adds UTF8 BOM to file.
 // file_name            File name with full path to file. Encoding: ASCII or UTF8.
 // text                 Text to be saved in file. Encoding: ASCI or UTF8.
+// new_line             (Optional) Decides how new line characters are saved.
 // Returns              true    - if entire text has been loaded from file,
 //                      false   - otherwise.
-bool SaveTextToFileUTF8_BOM(const std::string& file_name, const std::string& text);
+bool SaveTextToFileUTF8_BOM(const std::string& file_name, const std::string& text, ToStr_NewLine new_line = TOSTR_NEW_LINE_LF);
+
+// Saves text to file in UTF16 format. Text is converted in small chunks while being saved, so converted copy of entire text is never created.
+// Invalid unicode will be replaced with 'FFFD' code.
+// file_name            File name with full path to file. Encoding: ASCII or UTF8.
+// text                 Text to be saved in file. Encoding: ASCII or UTF8.
+// byte_order           (Optional) Byte order of utf16 code units in file.
+// new_line             (Optional) Decides how new line characters are saved.
+// Returns              true    - if entire text has been saved to file,
+//                      false   - otherwise.
+bool SaveTextToFileUTF16(const std::string& file_name, const std::string& text, ToStr_ByteOrder byte_order = TOSTR_BYTE_ORDER_LE, ToStr_NewLine new_line = TOSTR_NEW_LINE_LF);
+
+// Saves text to file in UTF16 format. Adds UTF16 BOM (in selected byte order) to file. Same rules as for SaveTextToFileUTF16.
+bool SaveTextToFileUTF16_BOM(const std::string& file_name, const std::string& text, ToStr_ByteOrder byte_order = TOSTR_BYTE_ORDER_LE, ToStr_NewLine new_line = TOSTR_NEW_LINE_LF);
+
+// Saves text from builder to file in UTF8 format. Text is not put together before saving.
+// file_name            File name with full path to file. Encoding: ASCII or UTF8.
+// builder              Builder with text to be saved in file. Encoding: ASCII or UTF8.
+// Returns              true    - if entire text has been saved to file,
+//                      false   - otherwise.
+bool SaveTextToFileUTF8(const std::string& file_name, const ToStrBuilder& builder);
 
 //------------------------------------------------------------------------------
 // Inner (only to use internally by this lib)
@@ -127,11 +559,15 @@ bool SaveTextToFileUTF8_BOM(const std::string& file_name, const std::string& tex
 
 struct ToStr_Data {
     void (*handle_fatal_error_message)(const char* message);
+    ToStr_FlushMode print_flush_mode;
+    size_t          print_flush_batch_size;
 };
 
 inline ToStr_Data& ToStr_ToData() {
     static ToStr_Data s_data = {
-        ToStr_DefaultHandleFatalErrorMessage
+        ToStr_DefaultHandleFatalErrorMessage,
+        TOSTR_FLUSH_MODE_NONE,
+        TOSTR_DEFAULT_FLUSH_BATCH_SIZE,
     };
 
     return s_data;
@@ -143,6 +579,16 @@ inline void ToStr_FatalError(const char* message) {
     exit(EXIT_FAILURE);
 }
 
+inline unsigned ToStr_CountTrailingZeros(uint32_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return index;
+#else
+    return __builtin_ctz(value);
+#endif
+}
+
 //------------------------------------------------------------------------------
 
 inline std::string ToUTF8(const std::wstring& text_utf16) {
@@ -207,175 +653,2550 @@ inline std::wstring ToUTF16(const std::string& text_utf8) {
 
 //------------------------------------------------------------------------------
 
-inline std::string ToStr(const char* text) {
-    if (text == nullptr) {
-        ToStr_FatalError("ToStr Error: Argument 'text' can not be 0 or nullptr.");
-    } 
-    return std::string(text);
+enum { TOSTR_REPLACEMENT_CHARACTER = 0xFFFD };
+
+// Returns true, if all 16 bytes are ascii characters.
+inline bool ToStr_IsASCII16(const char* text) {
+#ifdef TOSTR_SSE2
+    return _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)text)) == 0;
+#else
+    uint64_t blocks[2];
+    memcpy(blocks, text, 16);
+    return ((blocks[0] | blocks[1]) & 0x8080808080808080ull) == 0;
+#endif
 }
 
+// Decodes one code point from utf8 text. Invalid sequence is decoded as replacement character.
+// Invalid sequence is consumed up to first byte which breaks it (maximal subpart), same as by system conversion functions.
+// Returns              Number of consumed bytes (at least 1).
+inline size_t ToStr_DecodeUTF8(const unsigned char* text, size_t length, char32_t& code) {
+    const unsigned char lead = text[0];
 
-inline std::string ToStr(const std::string& text) {
-    return text;
-}
+    if (lead < 0x80) {
+        code = lead;
+        return 1;
+    }
 
-template <typename... Types>
-std::string ToStr(const char* format, Types&&... arguments) {
-    std::string text;
+    size_t      count;
+    unsigned    lower = 0x80;
+    unsigned    upper = 0xBF;
+
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        count   = 2;
+        code    = lead & 0x1F;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        count   = 3;
+        code    = lead & 0x0F;
+        if (lead == 0xE0) lower = 0xA0; // overlong
+        if (lead == 0xED) upper = 0x9F; // surrogates
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        count   = 4;
+        code    = lead & 0x07;
+        if (lead == 0xF0) lower = 0x90; // overlong
+        if (lead == 0xF4) upper = 0x8F; // above 10FFFF
+    } else {
+        code = TOSTR_REPLACEMENT_CHARACTER;
+        return 1;
+    }
 
-    char stack_buffer[TOSTR_MIN_BUFFER_SIZE];
+    for (size_t index = 1; index < count; ++index) {
+        if (index >= length || text[index] < lower || text[index] > upper) {
+            code = TOSTR_REPLACEMENT_CHARACTER;
+            return index;
+        }
+        code = (code << 6) | (text[index] & 0x3F);
+        lower = 0x80;
+        upper = 0xBF;
+    }
 
-    if (format == nullptr) {
-        ToStr_FatalError("ToStr Error: Argument 'format' can not be 0 or nullptr.");
-    } 
+    return count;
+}
 
-    const int length = snprintf(stack_buffer, TOSTR_MIN_BUFFER_SIZE, format, arguments...);
+// Returns              Valid code point or replacement character.
+inline char32_t ToStr_ToValidCodePoint(char32_t code) {
+    return (code > 0x10FFFF || (code >= 0xD800 && code <= 0xDFFF)) ? char32_t(TOSTR_REPLACEMENT_CHARACTER) : code;
+}
 
-    if (length < 0) {
-        ToStr_FatalError("ToStr Error: Encoding error.");
+// Encodes valid code point into utf8.
+// Returns              Number of written bytes.
+inline size_t ToStr_EncodeUTF8(char32_t code, char* text) {
+    if (code < 0x80) {
+        text[0] = char(code);
+        return 1;
     } 
+    if (code < 0x800) {
+        text[0] = char(0xC0 | (code >> 6));
+        text[1] = char(0x80 | (code & 0x3F));
+        return 2;
+    } 
+    if (code < 0x10000) {
+        text[0] = char(0xE0 | (code >> 12));
+        text[1] = char(0x80 | ((code >> 6) & 0x3F));
+        text[2] = char(0x80 | (code & 0x3F));
+        return 3;
+    } 
+    text[0] = char(0xF0 | (code >> 18));
+    text[1] = char(0x80 | ((code >> 12) & 0x3F));
+    text[2] = char(0x80 | ((code >> 6) & 0x3F));
+    text[3] = char(0x80 | (code & 0x3F));
+    return 4;
+}
 
-    if (length >= TOSTR_MIN_BUFFER_SIZE) {
-        const size_t    size    = length + 1;
-        char*           buffer  = new char[size];
-
-        const int expected_same_length = snprintf(buffer, size, format, arguments...);
+inline std::u32string ToUTF32(const std::string& text_utf8) {
+    std::u32string text_utf32;
+    ToUTF32(text_utf8, text_utf32);
+    text_utf32.shrink_to_fit(); // releases memory reserved for the worst case
+    return text_utf32;
+}
 
-        if (expected_same_length < 0) {
-            ToStr_FatalError("ToStr Error: Encoding error at second writing to buffer.");
-        } 
-        if (expected_same_length != length) {
-            ToStr_FatalError("ToStr Error: Message actual length miss-match between first and second write to buffer.");
+inline void ToUTF32(const std::string& text_utf8, std::u32string& text_utf32) {
+    const unsigned char*    source  = (const unsigned char*)text_utf8.data();
+    const size_t            length  = text_utf8.length();
+
+    text_utf32.resize(length); // utf32 text is never longer than utf8 one
+    char32_t* target = &text_utf32[0];
+
+    size_t index = 0;
+    while (index < length) {
+        if (source[index] < 0x80 && index + 16 <= length && ToStr_IsASCII16((const char*)source + index)) {
+#ifdef TOSTR_SSE2
+            const __m128i zero      = _mm_setzero_si128();
+            const __m128i bytes     = _mm_loadu_si128((const __m128i*)(source + index));
+            const __m128i low       = _mm_unpacklo_epi8(bytes, zero);
+            const __m128i high      = _mm_unpackhi_epi8(bytes, zero);
+
+            _mm_storeu_si128((__m128i*)(target + 0),  _mm_unpacklo_epi16(low, zero));
+            _mm_storeu_si128((__m128i*)(target + 4),  _mm_unpackhi_epi16(low, zero));
+            _mm_storeu_si128((__m128i*)(target + 8),  _mm_unpacklo_epi16(high, zero));
+            _mm_storeu_si128((__m128i*)(target + 12), _mm_unpackhi_epi16(high, zero));
+#else
+            for (size_t offset = 0; offset < 16; ++offset) target[offset] = source[index + offset];
+#endif
+            index   += 16;
+            target  += 16;
+        } else {
+            index += ToStr_DecodeUTF8(source + index, length - index, *target++);
         }
-
-        text = std::string(buffer, length);
-
-        delete[] buffer;
-    } else {
-        text = std::string(stack_buffer, length);
     }
 
-    return text;
+    text_utf32.resize(target - text_utf32.data());
 }
 
-template <typename... Types>
-inline std::string ToStr(const std::string& format, Types&&... arguments) {
-    return ToStr(format.c_str(), std::forward<Types>(arguments)...);
+inline std::u32string ToUTF32(const std::wstring& text_utf16) {
+    std::u32string text_utf32;
+    ToUTF32(text_utf16, text_utf32);
+    text_utf32.shrink_to_fit(); // releases memory reserved for the worst case
+    return text_utf32;
 }
 
-inline void ToStr_SetHandleFatalErrorMessageFunction(void (*handle_fatal_error_message)(const char* message)) {
-    ToStr_ToData().handle_fatal_error_message = handle_fatal_error_message;
-}
+inline void ToUTF32(const std::wstring& text_utf16, std::u32string& text_utf32) {
+    const wchar_t*  source  = text_utf16.data();
+    const size_t    length  = text_utf16.length();
 
-inline void ToStr_DefaultHandleFatalErrorMessage(const char* message) {
-    if (fwide(stdout, 0) > 0) {
-        wprintf(L"%hs\n", message);
-    } else {
-        puts(message);
+    text_utf32.resize(length); // utf32 text is never longer than utf16 one
+    char32_t* target = &text_utf32[0];
+
+    for (size_t index = 0; index < length; ++index) {
+        const char32_t unit = char16_t(source[index]);
+
+        if (unit >= 0xD800 && unit <= 0xDBFF && index + 1 < length && char16_t(source[index + 1]) >= 0xDC00 && char16_t(source[index + 1]) <= 0xDFFF) {
+            *target++ = 0x10000 + ((unit - 0xD800) << 10) + (char16_t(source[index + 1]) - 0xDC00);
+            ++index;
+        } else {
+            *target++ = ToStr_ToValidCodePoint(unit);
+        }
     }
-    fflush(stdout);
+
+    text_utf32.resize(target - text_utf32.data());
 }
 
-//------------------------------------------------------------------------------
+inline std::string ToUTF8(const std::u32string& text_utf32) {
+    std::string text_utf8;
+    ToUTF8(text_utf32, text_utf8);
+    return text_utf8;
+}
 
-class ToStr_LocaleGuardian {
-public:
-    ToStr_LocaleGuardian(int category, const char* locale) {
-        char* beckup = setlocale(LC_ALL, ".UTF8");
-        m_backup = beckup ? std::string(beckup) : "";
-    }
-    virtual ~ToStr_LocaleGuardian() {
-        if (!m_backup.empty()) setlocale(LC_ALL, m_backup.c_str());
+inline void ToUTF8(const std::u32string& text_utf32, std::string& text_utf8) {
+    const char32_t* source  = text_utf32.data();
+    const size_t    length  = text_utf32.length();
+
+    // exact size, so memory is not overallocated
+    size_t size = 0;
+    for (size_t index = 0; index < length; ++index) {
+        const char32_t code = ToStr_ToValidCodePoint(source[index]);
+        size += (code < 0x80) ? 1 : (code < 0x800) ? 2 : (code < 0x10000) ? 3 : 4;
     }
-private:
-    std::string m_backup;
-};
 
-#define TOSTR_LOCALE_GUARDIAN_UTF8() ToStr_LocaleGuardian locale_guardian_utf8(LC_ALL, ".UTF8")
+    text_utf8.resize(size);
+    char* target = &text_utf8[0];
 
-inline std::string LoadTextFromFile(const std::string& file_name, bool* is_loaded) {
-    std::string text;
+    size_t index = 0;
+    while (index < length) {
+#ifdef TOSTR_SSE2
+        if (index + 16 <= length) {
+            const __m128i block0 = _mm_loadu_si128((const __m128i*)(source + index + 0));
+            const __m128i block1 = _mm_loadu_si128((const __m128i*)(source + index + 4));
+            const __m128i block2 = _mm_loadu_si128((const __m128i*)(source + index + 8));
+            const __m128i block3 = _mm_loadu_si128((const __m128i*)(source + index + 12));
 
-    FILE* file = nullptr;
-    if (fopen_s(&file, file_name.c_str(), "rt") == 0 && file) {
+            const __m128i all = _mm_or_si128(_mm_or_si128(block0, block1), _mm_or_si128(block2, block3));
 
-        char c;
-        while ((c = fgetc(file)) != EOF) text += c;
-        fclose(file);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_andnot_si128(_mm_set1_epi32(0x7F), all), _mm_setzero_si128())) == 0xFFFF) {
+                const __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(block0, block1), _mm_packs_epi32(block2, block3));
+                _mm_storeu_si128((__m128i*)target, bytes);
 
-        if (is_loaded) *is_loaded = true;
-    } else {
-        if (is_loaded) *is_loaded = false;
+                index   += 16;
+                target  += 16;
+                continue;
+            }
+        }
+#endif
+        target += ToStr_EncodeUTF8(ToStr_ToValidCodePoint(source[index]), target);
+        ++index;
     }
+}
 
-    return text;
+inline std::wstring ToUTF16(const std::u32string& text_utf32) {
+    std::wstring text_utf16;
+    ToUTF16(text_utf32, text_utf16);
+    return text_utf16;
 }
 
-inline std::string LoadTextFromFileUTF8(const std::string& file_name, bool* is_loaded) {
-    std::string text;
+inline void ToUTF16(const std::u32string& text_utf32, std::wstring& text_utf16) {
+    const char32_t* source  = text_utf32.data();
+    const size_t    length  = text_utf32.length();
 
-    FILE* file = nullptr;
-    if (_wfopen_s(&file, ToUTF16(file_name).c_str(), L"rb") == 0 && file) {
-        char c;
-        while (fread(&c, sizeof(char), 1, file) == 1) {
-            if (c != '\r') text += c; // suppress 'carriage return' (CR)
-        }
+    size_t size = 0;
+    for (size_t index = 0; index < length; ++index) {
+        size += (ToStr_ToValidCodePoint(source[index]) >= 0x10000) ? 2 : 1;
+    }
 
-        const bool is_all_read = feof(file);
+    text_utf16.resize(size);
+    wchar_t* target = &text_utf16[0];
 
-        fclose(file);
+    for (size_t index = 0; index < length; ++index) {
+        const char32_t code = ToStr_ToValidCodePoint(source[index]);
 
-        if (is_loaded) *is_loaded = is_all_read;
-    } else {
-        if (is_loaded) *is_loaded = false;
+        if (code >= 0x10000) {
+            *target++ = wchar_t(0xD800 + ((code - 0x10000) >> 10));
+            *target++ = wchar_t(0xDC00 + ((code - 0x10000) & 0x3FF));
+        } else {
+            *target++ = wchar_t(code);
+        }
     }
-
-    return text;
 }
 
-inline std::string LoadTextFromFileUTF8_BOM(const std::string& file_name, bool* is_loaded) {
-    std::wstring text;
+inline std::string Latin1ToUTF8(const std::string& text_latin1) {
+    std::string text_utf8;
+    Latin1ToUTF8(text_latin1, text_utf8);
+    return text_utf8;
+}
 
-    FILE* file = nullptr;
-    if (_wfopen_s(&file, ToUTF16(file_name).c_str(), L"rt, ccs=UTF-8") == 0 && file) {
+inline void Latin1ToUTF8(const std::string& text_latin1, std::string& text_utf8) {
+    const unsigned char*    source  = (const unsigned char*)text_latin1.data();
+    const size_t            length  = text_latin1.length();
 
-        wchar_t c;
-        while ((c = fgetwc(file)) != WEOF) text += c;
-        fclose(file);
+    // exact size, so memory is not overallocated (each non-ascii latin1 character takes 2 bytes in utf8)
+    size_t size = length;
+    for (size_t index = 0; index < length; ++index) {
+        size += source[index] >> 7;
+    }
 
-        if (is_loaded) *is_loaded = true;
-    } else {
-        if (is_loaded) *is_loaded = false;
+    text_utf8.resize(size);
+    char* target = &text_utf8[0];
+
+    size_t index = 0;
+    while (index < length) {
+        if (index + 16 <= length && ToStr_IsASCII16((const char*)source + index)) {
+            memcpy(target, source + index, 16);
+            index   += 16;
+            target  += 16;
+        } else {
+            target += ToStr_EncodeUTF8(source[index++], target);
+        }
     }
+}
 
-    return ToUTF8(text);
+inline std::string ToLatin1(const std::string& text_utf8) {
+    std::string text_latin1;
+    ToLatin1(text_utf8, text_latin1);
+    text_latin1.shrink_to_fit(); // releases memory reserved for the worst case
+    return text_latin1;
 }
 
-inline bool SaveTextToFile(const std::string& file_name, const std::string& text) {
-    FILE* file = nullptr;
-    if (fopen_s(&file, file_name.c_str(), "wt") == 0 && file) {
-        const int count = fprintf(file, "%s", text.c_str());
-        fclose(file);
+inline void ToLatin1(const std::string& text_utf8, std::string& text_latin1) {
+    const unsigned char*    source  = (const unsigned char*)text_utf8.data();
+    const size_t            length  = text_utf8.length();
 
-        return count == text.length();
+    text_latin1.resize(length); // latin1 text is never longer than utf8 one
+    char* target = &text_latin1[0];
+
+    size_t index = 0;
+    while (index < length) {
+        if (index + 16 <= length && ToStr_IsASCII16((const char*)source + index)) {
+            memcpy(target, source + index, 16);
+            index   += 16;
+            target  += 16;
+        } else {
+            char32_t code;
+            index += ToStr_DecodeUTF8(source + index, length - index, code);
+
+            *target++ = (code <= 0xFF) ? char(code) : '?'; // replacement character is also out of latin1
+        }
     }
 
-    return false;
+    text_latin1.resize(target - text_latin1.data());
 }
 
-inline bool SaveTextToFileUTF8(const std::string& file_name, const std::string& text) {
-    FILE* file = nullptr;
-    if (_wfopen_s(&file, ToUTF16(file_name).c_str(), L"wb") == 0 && file) {
-        const size_t count =  fwrite(text.c_str(), sizeof(char), text.length(), file);
-        fclose(file);
+//------------------------------------------------------------------------------
 
-        return count == text.length();
+#ifndef TOSTR_SHARED_FORMAT
+#define TOSTR_FORMAT_NOINLINE
+#elif defined(_MSC_VER)
+#define TOSTR_FORMAT_NOINLINE __declspec(noinline)
+#else
+#define TOSTR_FORMAT_NOINLINE __attribute__((noinline))
+#endif
+
+enum ToStr_ArgumentType {
+    TOSTR_ARGUMENT_TYPE_SIGNED,         // any signed integer (or enumeration)
+    TOSTR_ARGUMENT_TYPE_UNSIGNED,       // any unsigned integer (or enumeration)
+    TOSTR_ARGUMENT_TYPE_DOUBLE,         // float or double
+    TOSTR_ARGUMENT_TYPE_LONG_DOUBLE,
+    TOSTR_ARGUMENT_TYPE_POINTER,        // any pointer, also c string
+};
+
+// Argument of formatting function, with erased type.
+struct ToStr_Argument {
+    ToStr_ArgumentType  type;
+    union {
+        int64_t         signed_value;
+        uint64_t        unsigned_value;
+        double          double_value;
+        long double     long_double_value;
+        const void*     pointer;
+    };
+};
+
+template <typename Type>
+inline ToStr_Argument ToStr_ToArgument(const Type& value) {
+    typedef typename std::decay<Type>::type DecayedType;
+
+    ToStr_Argument argument = {};
+
+    if constexpr (std::is_enum<DecayedType>::value) {
+        return ToStr_ToArgument(static_cast<typename std::underlying_type<DecayedType>::type>(value));
+    } else if constexpr (std::is_integral<DecayedType>::value && std::is_signed<DecayedType>::value) {
+        argument.type           = TOSTR_ARGUMENT_TYPE_SIGNED;
+        argument.signed_value   = value;
+    } else if constexpr (std::is_integral<DecayedType>::value) {
+        argument.type           = TOSTR_ARGUMENT_TYPE_UNSIGNED;
+        argument.unsigned_value = value;
+    } else if constexpr (std::is_same<DecayedType, long double>::value) {
+        argument.type               = TOSTR_ARGUMENT_TYPE_LONG_DOUBLE;
+        argument.long_double_value  = value;
+    } else if constexpr (std::is_floating_point<DecayedType>::value) {
+        argument.type           = TOSTR_ARGUMENT_TYPE_DOUBLE;
+        argument.double_value   = value;
+    } else if constexpr (std::is_pointer<DecayedType>::value || std::is_null_pointer<DecayedType>::value) {
+        argument.type           = TOSTR_ARGUMENT_TYPE_POINTER;
+        argument.pointer        = (const void*)(value);
+    } else {
+        static_assert(sizeof(Type) == 0, "ToStr Error: Type of argument can not be formatted (only numbers, enumerations, pointers and c strings can be).");
+    }
+
+    return argument;
+}
+
+enum ToStr_LengthModifier {
+    TOSTR_LENGTH_MODIFIER_NONE,
+    TOSTR_LENGTH_MODIFIER_HH,
+    TOSTR_LENGTH_MODIFIER_H,
+    TOSTR_LENGTH_MODIFIER_L,
+    TOSTR_LENGTH_MODIFIER_LL,
+    TOSTR_LENGTH_MODIFIER_BIG_L,
+    TOSTR_LENGTH_MODIFIER_J,
+    TOSTR_LENGTH_MODIFIER_Z,
+    TOSTR_LENGTH_MODIFIER_T,
+    TOSTR_LENGTH_MODIFIER_I,
+    TOSTR_LENGTH_MODIFIER_I32,
+    TOSTR_LENGTH_MODIFIER_I64,
+    TOSTR_LENGTH_MODIFIER_W,
+};
+
+enum {
+    TOSTR_FORMAT_ERROR_ENCODING     = -1,   // encoding error (as from 'snprintf')
+    TOSTR_FORMAT_ERROR_ARGUMENTS    = -2,   // arguments do not match format (not enough of them, wrong type, or invalid conversion specification)
+};
+
+// Formats arguments according to the format into buffer, as 'snprintf' does 
+// (text is truncated to 'size - 1' characters and is always null terminated, if 'size' is not 0).
+// Format is parsed here. Each conversion specification is formatted by 'snprintf', with its argument cast to type expected by the specification.
+// Width and precision given as '*' are replaced by values from arguments.
+// buffer           Buffer for text. Can be nullptr, if 'size' is 0.
+// arguments        Arguments for conversion specifications, in order of their appearance in format.
+// count            Number of arguments.
+// Returns          Length of entire formatted text (without terminating null), 
+//                  or TOSTR_FORMAT_ERROR_ARGUMENTS if arguments do not match format, 
+//                  or TOSTR_FORMAT_ERROR_ENCODING if an encoding error occurred.
+TOSTR_FORMAT_NOINLINE inline int ToStr_FormatToBuffer(char* buffer, size_t size, const char* format, const ToStr_Argument* arguments, size_t count) {
+    size_t length   = 0;
+    size_t index    = 0; // of next argument
+
+    auto Append = [&](const char* text, size_t text_length) {
+        if (length < size) memcpy(buffer + length, text, (std::min)(text_length, size - length));
+        length += text_length;
+    };
+
+    auto ToInteger = [&](int64_t& value) -> bool {
+        if (index >= count) return false;
+        const ToStr_Argument& argument = arguments[index++];
+
+        switch (argument.type) {
+        case TOSTR_ARGUMENT_TYPE_SIGNED:    value = argument.signed_value;                      return true;
+        case TOSTR_ARGUMENT_TYPE_UNSIGNED:  value = int64_t(argument.unsigned_value);           return true;
+        case TOSTR_ARGUMENT_TYPE_POINTER:   value = int64_t(uintptr_t(argument.pointer));       return true;
+        default:                                                                                return false;
+        }
+    };
+
+    const char* position = format;
+
+    while (*position != '\0') {
+        const char* percent = strchr(position, '%');
+        const size_t text_length = percent ? size_t(percent - position) : strlen(position);
+
+        Append(position, text_length);
+        position += text_length;
+
+        if (percent == nullptr) break;
+        ++position;
+
+        if (*position == '%') {
+            Append("%", 1);
+            ++position;
+            continue;
+        }
+
+        // conversion specification for 'snprintf', with numbers in place of '*'
+        char    spec[64];
+        size_t  spec_length = 0;
+
+        auto AddToSpec = [&](const char* text, size_t text_length) -> bool {
+            if (spec_length + text_length >= sizeof(spec)) return false;
+            memcpy(spec + spec_length, text, text_length);
+            spec_length += text_length;
+            return true;
+        };
+
+        auto AddNumberToSpec = [&](int64_t number) -> bool {
+            char text[24];
+            const int text_length = snprintf(text, sizeof(text), "%lld", (long long)number);
+            return text_length > 0 && AddToSpec(text, text_length);
+        };
+
+        auto AddDigitsToSpec = [&]() -> bool {
+            const char* begin = position;
+            while (*position >= '0' && *position <= '9') ++position;
+            return AddToSpec(begin, position - begin);
+        };
+
+        AddToSpec("%", 1);
+
+        // flags
+        while (*position != '\0' && strchr("-+ #0", *position)) {
+            if (!AddToSpec(position++, 1)) return TOSTR_FORMAT_ERROR_ARGUMENTS;
+        }
+
+        // width
+        if (*position == '*') {
+            ++position;
+            int64_t width;
+            if (!ToInteger(width) || !AddNumberToSpec(int(width))) return TOSTR_FORMAT_ERROR_ARGUMENTS; // negative width is the same as '-' flag, so it can stay
+        } else if (!AddDigitsToSpec()) {
+            return TOSTR_FORMAT_ERROR_ARGUMENTS;
+        }
+
+        // precision
+        if (*position == '.') {
+            ++position;
+            if (*position == '*') {
+                ++position;
+                int64_t precision;
+                if (!ToInteger(precision)) return TOSTR_FORMAT_ERROR_ARGUMENTS;
+                if (int(precision) >= 0 && (!AddToSpec(".", 1) || !AddNumberToSpec(int(precision)))) return TOSTR_FORMAT_ERROR_ARGUMENTS; // negative precision is the same as omitted one
+            } else if (!AddToSpec(".", 1) || !AddDigitsToSpec()) {
+                return TOSTR_FORMAT_ERROR_ARGUMENTS;
+            }
+        }
+
+        // length modifier
+        const char*             modifier_begin  = position;
+        ToStr_LengthModifier    modifier        = TOSTR_LENGTH_MODIFIER_NONE;
+
+        switch (*position) {
+        case 'h': modifier = (position[1] == 'h') ? TOSTR_LENGTH_MODIFIER_HH : TOSTR_LENGTH_MODIFIER_H; break;
+        case 'l': modifier = (position[1] == 'l') ? TOSTR_LENGTH_MODIFIER_LL : TOSTR_LENGTH_MODIFIER_L; break;
+        case 'L': modifier = TOSTR_LENGTH_MODIFIER_BIG_L;   break;
+        case 'j': modifier = TOSTR_LENGTH_MODIFIER_J;       break;
+        case 'z': modifier = TOSTR_LENGTH_MODIFIER_Z;       break;
+        case 't': modifier = TOSTR_LENGTH_MODIFIER_T;       break;
+        case 'w': modifier = TOSTR_LENGTH_MODIFIER_W;       break;
+        case 'I':
+            modifier = (position[1] == '3' && position[2] == '2') ? TOSTR_LENGTH_MODIFIER_I32 : 
+                       (position[1] == '6' && position[2] == '4') ? TOSTR_LENGTH_MODIFIER_I64 : 
+                       TOSTR_LENGTH_MODIFIER_I;
+            break;
+        default:
+            break;
+        }
+
+        switch (modifier) {
+        case TOSTR_LENGTH_MODIFIER_NONE:                                            break;
+        case TOSTR_LENGTH_MODIFIER_HH: case TOSTR_LENGTH_MODIFIER_LL:               position += 2; break;
+        case TOSTR_LENGTH_MODIFIER_I32: case TOSTR_LENGTH_MODIFIER_I64:             position += 3; break;
+        default:                                                                    position += 1; break;
+        }
+
+        if (!AddToSpec(modifier_begin, position - modifier_begin)) return TOSTR_FORMAT_ERROR_ARGUMENTS;
+
+        // conversion
+        const char conversion = *position;
+        if (conversion == '\0' || !AddToSpec(position++, 1)) return TOSTR_FORMAT_ERROR_ARGUMENTS;
+        spec[spec_length] = '\0';
+
+        char* const     destination         = (length < size) ? (buffer + length) : nullptr;
+        const size_t    destination_size    = (length < size) ? (size - length) : 0;
+        int             written             = -1;
+
+        switch (conversion) {
+        case 'd': case 'i': {
+            int64_t value;
+            if (!ToInteger(value)) return TOSTR_FORMAT_ERROR_ARGUMENTS;
+
+            switch (modifier) {
+            case TOSTR_LENGTH_MODIFIER_L:       written = snprintf(destination, destination_size, spec, long(value));          break;
+            case TOSTR_LENGTH_MODIFIER_LL:
+            case TOSTR_LENGTH_MODIFIER_BIG_L:
+            case TOSTR_LENGTH_MODIFIER_I64:     written = snprintf(destination, destination_size, spec, (long long)(value));   break;
+            case TOSTR_LENGTH_MODIFIER_J:       written = snprintf(destination, destination_size, spec, intmax_t(value));      break;
+            case TOSTR_LENGTH_MODIFIER_Z:
+            case TOSTR_LENGTH_MODIFIER_T:
+            case TOSTR_LENGTH_MODIFIER_I:       written = snprintf(destination, destination_size, spec, ptrdiff_t(value));     break;
+            default:                            written = snprintf(destination, destination_size, spec, int(value));           break;
+            }
+            break;
+        }
+
+        case 'o': case 'u': case 'x': case 'X': {
+            int64_t value;
+            if (!ToInteger(value)) return TOSTR_FORMAT_ERROR_ARGUMENTS;
+
+            switch (modifier) {
+            case TOSTR_LENGTH_MODIFIER_L:       written = snprintf(destination, destination_size, spec, (unsigned long)(value));       break;
+            case TOSTR_LENGTH_MODIFIER_LL:
+            case TOSTR_LENGTH_MODIFIER_BIG_L:
+            case TOSTR_LENGTH_MODIFIER_I64:     written = snprintf(destination, destination_size, spec, (unsigned long long)(value));  break;
+            case TOSTR_LENGTH_MODIFIER_J:       written = snprintf(destination, destination_size, spec, uintmax_t(value));             break;
+            case TOSTR_LENGTH_MODIFIER_Z:
+            case TOSTR_LENGTH_MODIFIER_T:
+            case TOSTR_LENGTH_MODIFIER_I:       written = snprintf(destination, destination_size, spec, size_t(value));                break;
+            default:                            written = snprintf(destination, destination_size, spec, unsigned(value));              break;
+            }
+            break;
+        }
+
+        case 'c': case 'C': {
+            int64_t value;
+            if (!ToInteger(value)) return TOSTR_FORMAT_ERROR_ARGUMENTS;
+
+            const bool is_wide = conversion == 'C' || modifier == TOSTR_LENGTH_MODIFIER_L || modifier == TOSTR_LENGTH_MODIFIER_W;
+
+            written = is_wide ? snprintf(destination, destination_size, spec, wint_t(value)) : snprintf(destination, destination_size, spec, int(value));
+            break;
+        }
+
+        case 's': case 'S': case 'p': {
+            if (index >= count) return TOSTR_FORMAT_ERROR_ARGUMENTS;
+            const ToStr_Argument& argument = arguments[index++];
+
+            const void* pointer;
+            switch (argument.type) {
+            case TOSTR_ARGUMENT_TYPE_POINTER:   pointer = argument.pointer;                             break;
+            case TOSTR_ARGUMENT_TYPE_SIGNED:
+            case TOSTR_ARGUMENT_TYPE_UNSIGNED:  pointer = (const void*)uintptr_t(argument.unsigned_value);    break;
+            default:                            return TOSTR_FORMAT_ERROR_ARGUMENTS;
+            }
+
+            const bool is_wide = conversion == 'S' || modifier == TOSTR_LENGTH_MODIFIER_L || modifier == TOSTR_LENGTH_MODIFIER_W;
+
+            if (conversion == 'p') {
+                written = snprintf(destination, destination_size, spec, pointer);
+            } else if (is_wide) {
+                written = snprintf(destination, destination_size, spec, static_cast<const wchar_t*>(pointer));
+            } else {
+                written = snprintf(destination, destination_size, spec, static_cast<const char*>(pointer));
+            }
+            break;
+        }
+
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+            if (index >= count) return TOSTR_FORMAT_ERROR_ARGUMENTS;
+            const ToStr_Argument& argument = arguments[index++];
+
+            long double value;
+            switch (argument.type) {
+            case TOSTR_ARGUMENT_TYPE_DOUBLE:        value = argument.double_value;      break;
+            case TOSTR_ARGUMENT_TYPE_LONG_DOUBLE:   value = argument.long_double_value; break;
+            default:                                return TOSTR_FORMAT_ERROR_ARGUMENTS;
+            }
+
+            if (modifier == TOSTR_LENGTH_MODIFIER_BIG_L) {
+                written = snprintf(destination, destination_size, spec, value);
+            } else {
+                written = snprintf(destination, destination_size, spec, double(value));
+            }
+            break;
+        }
+
+        default: 
+            return TOSTR_FORMAT_ERROR_ARGUMENTS; // unknown conversion, or '%n'
+        }
+
+        if (written < 0) return TOSTR_FORMAT_ERROR_ENCODING;
+        length += written;
+    }
+
+    if (size > 0) buffer[(std::min)(length, size - 1)] = '\0';
+
+    return (length > size_t((std::numeric_limits<int>::max)())) ? TOSTR_FORMAT_ERROR_ENCODING : int(length);
+}
+
+// Packed arguments with erased types. Formats them as 'snprintf' does.
+struct ToStr_ArgumentList {
+    const ToStr_Argument*   arguments;
+    size_t                  count;
+
+    int operator()(char* buffer, size_t size, const char* format) const {
+        return ToStr_FormatToBuffer(buffer, size, format, arguments, count);
+    }
+};
+
+// Declares formatter with given name, which formats arguments (function parameter pack) as 'snprintf' does.
+#ifdef TOSTR_SHARED_FORMAT
+#define TOSTR_FORMATTER(formatter, arguments) \
+    const ToStr_Argument formatter##_arguments[sizeof...(arguments) + 1] = { ToStr_ToArgument(arguments)..., ToStr_Argument() }; \
+    const ToStr_ArgumentList formatter = { formatter##_arguments, sizeof...(arguments) }
+#else
+#define TOSTR_FORMATTER(formatter, arguments) \
+    const auto formatter = [&](char* buffer, size_t size, const char* format) { return snprintf(buffer, size, format, arguments...); }
+#endif
+
+//------------------------------------------------------------------------------
+
+inline std::string ToStr(const char* text) {
+    if (text == nullptr) {
+        ToStr_FatalError("ToStr Error: Argument 'text' can not be 0 or nullptr.");
+    } 
+    return std::string(text);
+}
+
+
+inline std::string ToStr(const std::string& text) {
+    return text;
+}
+
+template <typename Formatter>
+TOSTR_FORMAT_NOINLINE inline std::string ToStr_FormatToStr(const char* format, const Formatter& formatter) {
+    std::string text;
+
+    char stack_buffer[TOSTR_MIN_BUFFER_SIZE];
+
+    if (format == nullptr) {
+        ToStr_FatalError("ToStr Error: Argument 'format' can not be 0 or nullptr.");
+    } 
+
+    const int length = formatter(stack_buffer, TOSTR_MIN_BUFFER_SIZE, format);
+
+    if (length == TOSTR_FORMAT_ERROR_ARGUMENTS) {
+        ToStr_FatalError("ToStr Error: Arguments do not match format.");
+    } 
+    if (length < 0) {
+        ToStr_FatalError("ToStr Error: Encoding error.");
+    } 
+
+    if (length >= TOSTR_MIN_BUFFER_SIZE) {
+        const size_t    size    = length + 1;
+        char*           buffer  = new char[size];
+
+        const int expected_same_length = formatter(buffer, size, format);
+
+        if (expected_same_length < 0) {
+            ToStr_FatalError("ToStr Error: Encoding error at second writing to buffer.");
+        } 
+        if (expected_same_length != length) {
+            ToStr_FatalError("ToStr Error: Message actual length miss-match between first and second write to buffer.");
+        }
+
+        text = std::string(buffer, length);
+
+        delete[] buffer;
+    } else {
+        text = std::string(stack_buffer, length);
+    }
+
+    return text;
+}
+
+template <typename... Types>
+std::string ToStr(const char* format, Types&&... arguments) {
+    TOSTR_FORMATTER(formatter, arguments);
+    return ToStr_FormatToStr(format, formatter);
+}
+
+template <typename... Types>
+inline std::string ToStr(const std::string& format, Types&&... arguments) {
+    return ToStr(format.c_str(), std::forward<Types>(arguments)...);
+}
+
+//------------------------------------------------------------------------------
+
+// Returns length of text without incomplete utf8 sequence at the end of text (if there is any).
+inline size_t ToStr_TrimIncompleteUTF8(const char* text, size_t length) {
+    for (size_t count = 1; count <= 4 && count <= length; ++count) {
+        const unsigned char c = text[length - count];
+
+        if ((c & 0xC0) != 0x80) {
+            // lead byte (or ascii), checks if its sequence is complete
+            const size_t expected_count = (c < 0x80) ? 1 : (c >= 0xF0) ? 4 : (c >= 0xE0) ? 3 : (c >= 0xC0) ? 2 : 1;
+            return (expected_count > count) ? (length - count) : length;
+        }
+    }
+    return length;
+}
+
+template <size_t CAPACITY>
+inline FixedString<CAPACITY>::FixedString() : m_length(0), m_is_truncated(false) {
+    m_text[0] = '\0'; // rest of text is not initialized, it is always overwritten before being read
+}
+
+template <size_t CAPACITY>
+inline FixedString<CAPACITY>::FixedString(std::string_view text) : FixedString() {
+    const size_t length = (text.size() > CAPACITY) ? CAPACITY : text.size();
+
+    memcpy(m_text, text.data(), length);
+    m_is_truncated = text.size() > CAPACITY;
+    SetLength(m_is_truncated ? ToStr_TrimIncompleteUTF8(m_text, length) : length);
+}
+
+// Formats text into buffer with given capacity (without terminating null).
+// Returns          Length of text (trimmed to capacity, without breaking utf8 sequences).
+template <typename Formatter>
+TOSTR_FORMAT_NOINLINE inline size_t ToStr_FormatToFixed(char* text, size_t capacity, const char* format, const Formatter& formatter, bool& is_truncated) {
+    if (format == nullptr) {
+        ToStr_FatalError("ToStrFixed Error: Argument 'format' can not be 0 or nullptr.");
+    } 
+
+    const int length = formatter(text, capacity + 1, format);
+
+    if (length == TOSTR_FORMAT_ERROR_ARGUMENTS) {
+        ToStr_FatalError("ToStrFixed Error: Arguments do not match format.");
+    } 
+    if (length < 0) {
+        ToStr_FatalError("ToStrFixed Error: Encoding error.");
+    } 
+
+    is_truncated = size_t(length) > capacity;
+    return is_truncated ? ToStr_TrimIncompleteUTF8(text, capacity) : size_t(length);
+}
+
+template <size_t CAPACITY>
+template <typename... Types>
+inline bool FixedString<CAPACITY>::Format(const char* format, Types&&... arguments) {
+    TOSTR_FORMATTER(formatter, arguments);
+    SetLength(ToStr_FormatToFixed(m_text, CAPACITY, format, formatter, m_is_truncated));
+
+    return !m_is_truncated;
+}
+
+template <size_t CAPACITY>
+inline const char* FixedString<CAPACITY>::ToCStr() const {
+    return m_text;
+}
+
+template <size_t CAPACITY>
+inline size_t FixedString<CAPACITY>::GetLength() const {
+    return m_length;
+}
+
+template <size_t CAPACITY>
+inline bool FixedString<CAPACITY>::IsEmpty() const {
+    return m_length == 0;
+}
+
+template <size_t CAPACITY>
+inline bool FixedString<CAPACITY>::IsTruncated() const {
+    return m_is_truncated;
+}
+
+template <size_t CAPACITY>
+inline FixedString<CAPACITY>::operator std::string_view() const {
+    return std::string_view(m_text, m_length);
+}
+
+template <size_t CAPACITY>
+inline FixedString<CAPACITY>::operator std::string() const {
+    return std::string(m_text, m_length);
+}
+
+template <size_t CAPACITY>
+inline void FixedString<CAPACITY>::SetLength(size_t length) {
+    m_length = length;
+    m_text[length] = '\0';
+}
+
+template <size_t CAPACITY>
+inline FixedString<CAPACITY> ToStrFixed(const char* text) {
+    if (text == nullptr) {
+        ToStr_FatalError("ToStrFixed Error: Argument 'text' can not be 0 or nullptr.");
+    } 
+    return FixedString<CAPACITY>(std::string_view(text));
+}
+
+template <size_t CAPACITY, typename... Types>
+inline FixedString<CAPACITY> ToStrFixed(const char* format, Types&&... arguments) {
+    FixedString<CAPACITY> text;
+    text.Format(format, std::forward<Types>(arguments)...);
+    return text;
+}
+
+//------------------------------------------------------------------------------
+
+inline ToStrBuilder::ToStrBuilder(size_t chunk_size) : m_chunk_size(chunk_size ? chunk_size : 1), m_length(0) {}
+
+template <typename Formatter>
+TOSTR_FORMAT_NOINLINE inline ToStrBuilder& ToStrBuilder::AppendFormatted(const char* format, const Formatter& formatter) {
+    if (format == nullptr) {
+        ToStr_FatalError("ToStrBuilder Error: Argument 'format' can not be 0 or nullptr.");
+    } 
+
+    // formats directly into free space of last chunk, if it fits (together with terminating null)
+    const size_t free_size = GetFreeSize();
+
+    const int length = formatter(ToEnd(), free_size, format);
+
+    if (length == TOSTR_FORMAT_ERROR_ARGUMENTS) {
+        ToStr_FatalError("ToStrBuilder Error: Arguments do not match format.");
+    } 
+    if (length < 0) {
+        ToStr_FatalError("ToStrBuilder Error: Encoding error.");
+    } 
+
+    if (size_t(length) >= free_size) {
+        AddChunk(size_t(length) + 1);
+
+        const int expected_same_length = formatter(ToEnd(), GetFreeSize(), format);
+
+        if (expected_same_length < 0) {
+            ToStr_FatalError("ToStrBuilder Error: Encoding error at second writing to buffer.");
+        } 
+        if (expected_same_length != length) {
+            ToStr_FatalError("ToStrBuilder Error: Message actual length miss-match between first and second write to buffer.");
+        }
+    }
+
+    m_chunks.back().length  += length;
+    m_length                += length;
+
+    return *this;
+}
+
+template <typename... Types>
+inline ToStrBuilder& ToStrBuilder::Append(const char* format, Types&&... arguments) {
+    TOSTR_FORMATTER(formatter, arguments);
+    return AppendFormatted(format, formatter);
+}
+
+inline ToStrBuilder& ToStrBuilder::Append(const char* text) {
+    if (text == nullptr) {
+        ToStr_FatalError("ToStrBuilder Error: Argument 'text' can not be 0 or nullptr.");
+    } 
+    return Append(std::string_view(text));
+}
+
+inline ToStrBuilder& ToStrBuilder::Append(const std::string& text) {
+    return Append(std::string_view(text));
+}
+
+inline ToStrBuilder& ToStrBuilder::Append(std::string_view text) {
+    const char* source  = text.data();
+    size_t      length  = text.length();
+
+    // fills free space of last chunk, then the rest goes to new chunk
+    while (length > 0) {
+        if (GetFreeSize() == 0) AddChunk(length);
+
+        const size_t count = (length < GetFreeSize()) ? length : GetFreeSize();
+        memcpy(ToEnd(), source, count);
+
+        m_chunks.back().length  += count;
+        m_length                += count;
+        source                  += count;
+        length                  -= count;
+    }
+
+    return *this;
+}
+
+inline size_t ToStrBuilder::GetLength() const {
+    return m_length;
+}
+
+inline bool ToStrBuilder::IsEmpty() const {
+    return m_length == 0;
+}
+
+inline void ToStrBuilder::Clear() {
+    m_chunks.clear();
+    m_length = 0;
+}
+
+inline std::string ToStrBuilder::ToString() const {
+    std::string text;
+    text.reserve(m_length);
+
+    for (const auto& chunk : m_chunks) text.append(chunk.data.get(), chunk.length);
+
+    return text;
+}
+
+inline bool ToStrBuilder::WriteToFile(FILE* file) const {
+    for (const auto& chunk : m_chunks) {
+        if (fwrite(chunk.data.get(), sizeof(char), chunk.length, file) != chunk.length) return false;
+    }
+    return true;
+}
+
+inline void ToStrBuilder::AddChunk(size_t min_capacity) {
+    const size_t capacity = (min_capacity > m_chunk_size) ? min_capacity : m_chunk_size;
+
+    m_chunks.push_back({std::unique_ptr<char[]>(new char[capacity]), 0, capacity});
+}
+
+inline char* ToStrBuilder::ToEnd() {
+    return m_chunks.empty() ? nullptr : (m_chunks.back().data.get() + m_chunks.back().length);
+}
+
+inline size_t ToStrBuilder::GetFreeSize() const {
+    return m_chunks.empty() ? 0 : (m_chunks.back().capacity - m_chunks.back().length);
+}
+
+//------------------------------------------------------------------------------
+
+// Checks if only wide characters can be written to file. 
+// Translation mode of file is read by '_setmode' (which is restored at once), because 'fwide' of msvc runtime does not report orientation of file.
+// Must be called under lock of the file.
+inline bool ToStr_IsWideFile(FILE* file) {
+    if (fwide(file, 0) > 0) return true;
+
+    const int descriptor = _fileno(file);
+    if (descriptor < 0) return false; // stream without file descriptor, for example stdout of application without console
+
+    const int mode = _setmode(descriptor, _O_BINARY);
+    if (mode == -1) return false;
+    _setmode(descriptor, mode);
+
+    return (mode & (_O_U16TEXT | _O_U8TEXT | _O_WTEXT)) != 0;
+}
+
+// Writes text to file under one lock of the file. Converts text to utf16, if file is wide. Flushes file according to flush mode.
+inline bool ToStr_PrintText(FILE* file, const char* text, size_t length) {
+    if (file == nullptr) {
+        ToStr_FatalError("ToStrPrint Error: Argument 'file' can not be 0 or nullptr.");
+    } 
+
+    wchar_t stack_buffer[TOSTR_MIN_BUFFER_SIZE];
+    wchar_t* buffer = nullptr;
+
+    _lock_file(file);
+
+    bool is_written;
+
+    if (ToStr_IsWideFile(file)) {
+        // utf16 text is never longer than utf8 one
+        buffer = (length + 1 > TOSTR_MIN_BUFFER_SIZE) ? (new wchar_t[length + 1]) : stack_buffer;
+
+        const int size = (length > 0) ? MultiByteToWideChar(CP_UTF8, 0, text, int(length), buffer, int(length)) : 0;
+        buffer[size] = L'\0';
+
+        is_written = (size > 0 || length == 0) && fputws(buffer, file) >= 0;
+    } else {
+        is_written = fwrite(text, sizeof(char), length, file) == length;
+    }
+
+    const ToStr_Data& data = ToStr_ToData();
+
+    // number of printed bytes since last flush, for each file with not flushed bytes
+    thread_local std::unordered_map<FILE*, size_t> s_unflushed_sizes;
+
+    switch (data.print_flush_mode) {
+    case TOSTR_FLUSH_MODE_EACH:
+        fflush(file);
+        break;
+
+    case TOSTR_FLUSH_MODE_BATCHED: {
+        size_t& unflushed_size = s_unflushed_sizes[file];
+
+        unflushed_size += length;
+
+        if (unflushed_size >= data.print_flush_batch_size) {
+            fflush(file);
+            s_unflushed_sizes.erase(file);
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    _unlock_file(file);
+
+    if (buffer != stack_buffer) delete[] buffer;
+
+    return is_written;
+}
+
+template <typename Formatter>
+TOSTR_FORMAT_NOINLINE inline bool ToStr_PrintFormatted(FILE* file, const char* format, const Formatter& formatter) {
+    char stack_buffer[TOSTR_MIN_BUFFER_SIZE];
+
+    if (format == nullptr) {
+        ToStr_FatalError("ToStrPrint Error: Argument 'format' can not be 0 or nullptr.");
+    } 
+
+    const int length = formatter(stack_buffer, TOSTR_MIN_BUFFER_SIZE, format);
+
+    if (length == TOSTR_FORMAT_ERROR_ARGUMENTS) {
+        ToStr_FatalError("ToStrPrint Error: Arguments do not match format.");
+    } 
+    if (length < 0) {
+        ToStr_FatalError("ToStrPrint Error: Encoding error.");
+    } 
+
+    if (length >= TOSTR_MIN_BUFFER_SIZE) {
+        const size_t    size    = length + 1;
+        char*           buffer  = new char[size];
+
+        const int expected_same_length = formatter(buffer, size, format);
+
+        if (expected_same_length < 0) {
+            ToStr_FatalError("ToStrPrint Error: Encoding error at second writing to buffer.");
+        } 
+        if (expected_same_length != length) {
+            ToStr_FatalError("ToStrPrint Error: Message actual length miss-match between first and second write to buffer.");
+        }
+
+        const bool is_written = ToStr_PrintText(file, buffer, length);
+
+        delete[] buffer;
+
+        return is_written;
+    } 
+
+    return ToStr_PrintText(file, stack_buffer, length);
+}
+
+template <typename... Types>
+inline bool ToStrPrint(FILE* file, const char* format, Types&&... arguments) {
+    TOSTR_FORMATTER(formatter, arguments);
+    return ToStr_PrintFormatted(file, format, formatter);
+}
+
+inline bool ToStrPrint(FILE* file, const char* text) {
+    if (text == nullptr) {
+        ToStr_FatalError("ToStrPrint Error: Argument 'text' can not be 0 or nullptr.");
+    } 
+    return ToStr_PrintText(file, text, strlen(text));
+}
+
+inline bool ToStrPrint(FILE* file, const std::string& text) {
+    return ToStr_PrintText(file, text.c_str(), text.length());
+}
+
+inline void ToStr_SetPrintFlushMode(ToStr_FlushMode flush_mode, size_t batch_size) {
+    ToStr_Data& data = ToStr_ToData();
+
+    data.print_flush_mode       = flush_mode;
+    data.print_flush_batch_size = batch_size;
+}
+
+//------------------------------------------------------------------------------
+
+inline void ToStr_SetHandleFatalErrorMessageFunction(void (*handle_fatal_error_message)(const char* message)) {
+    ToStr_ToData().handle_fatal_error_message = handle_fatal_error_message;
+}
+
+inline void ToStr_DefaultHandleFatalErrorMessage(const char* message) {
+    if (fwide(stdout, 0) > 0) {
+        wprintf(L"%hs\n", message);
+    } else {
+        puts(message);
+    }
+    fflush(stdout);
+}
+
+//------------------------------------------------------------------------------
+
+inline std::string ToHexStr(const void* data, size_t size) {
+    std::string text;
+    AppendHexStr(text, data, size);
+    return text;
+}
+
+inline std::string ToHexStr(std::string_view data) {
+    return ToHexStr(data.data(), data.size());
+}
+
+inline void AppendHexStr(std::string& text, const void* data, size_t size) {
+    constexpr static char DIGITS[] = "0123456789ABCDEF";
+
+    const unsigned char* source = (const unsigned char*)data;
+
+    const size_t previous_length = text.length();
+    text.resize(previous_length + size * 2);
+    char* target = &text[previous_length];
+
+    size_t index = 0;
+
+#ifdef TOSTR_SSE2
+    const __m128i low_mask  = _mm_set1_epi8(0x0F);
+    const __m128i nine      = _mm_set1_epi8(9);
+    const __m128i zero_char = _mm_set1_epi8('0');
+    const __m128i letter    = _mm_set1_epi8('A' - '0' - 10);
+
+    // digit to character: n + '0' + (n > 9 ? 'A' - '0' - 10 : 0)
+    auto ToChars = [&](__m128i digits) -> __m128i {
+        return _mm_add_epi8(_mm_add_epi8(digits, zero_char), _mm_and_si128(_mm_cmpgt_epi8(digits, nine), letter));
+    };
+
+    for (; index + 16 <= size; index += 16) {
+        const __m128i bytes = _mm_loadu_si128((const __m128i*)(source + index));
+        const __m128i high  = ToChars(_mm_and_si128(_mm_srli_epi16(bytes, 4), low_mask));
+        const __m128i low   = ToChars(_mm_and_si128(bytes, low_mask));
+
+        _mm_storeu_si128((__m128i*)(target + 0),  _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128((__m128i*)(target + 16), _mm_unpackhi_epi8(high, low));
+        target += 32;
+    }
+#endif
+
+    for (; index < size; ++index) {
+        *target++ = DIGITS[source[index] >> 4];
+        *target++ = DIGITS[source[index] & 0x0F];
+    }
+}
+
+enum ToStr_EscapeMode {
+    TOSTR_ESCAPE_MODE_JSON,
+    TOSTR_ESCAPE_MODE_C,
+};
+
+// Returns              Position of first character which needs to be escaped, or length of text if there is none.
+inline size_t ToStr_FindToEscape(const char* text, size_t length, ToStr_EscapeMode mode) {
+    auto IsToEscape = [mode](unsigned char c) -> bool {
+        return c < 0x20 || c == '"' || c == '\\' || (mode == TOSTR_ESCAPE_MODE_C && c == 0x7F);
+    };
+
+    size_t index = 0;
+
+#ifdef TOSTR_SSE2
+    const __m128i control   = _mm_set1_epi8(0x1F);
+    const __m128i quote     = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i del       = _mm_set1_epi8(mode == TOSTR_ESCAPE_MODE_C ? 0x7F : '"');
+
+    for (; index + 16 <= length; index += 16) {
+        const __m128i bytes = _mm_loadu_si128((const __m128i*)(text + index));
+
+        const __m128i found = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(_mm_max_epu8(bytes, control), control), _mm_cmpeq_epi8(bytes, quote)),
+            _mm_or_si128(_mm_cmpeq_epi8(bytes, backslash), _mm_cmpeq_epi8(bytes, del))
+        );
+
+        const uint32_t mask = (uint32_t)_mm_movemask_epi8(found);
+        if (mask) return index + ToStr_CountTrailingZeros(mask);
+    }
+#endif
+
+    for (; index < length; ++index) {
+        if (IsToEscape(text[index])) return index;
+    }
+    return length;
+}
+
+// Returns              Length of escape sequence written to 'sequence'.
+inline size_t ToStr_Escape(unsigned char c, ToStr_EscapeMode mode, char (&sequence)[8]) {
+    char short_form = 0;
+
+    switch (c) {
+    case '"':   short_form = '"';   break;
+    case '\\':  short_form = '\\';  break;
+    case '\b':  short_form = 'b';   break;
+    case '\f':  short_form = 'f';   break;
+    case '\n':  short_form = 'n';   break;
+    case '\r':  short_form = 'r';   break;
+    case '\t':  short_form = 't';   break;
+    case '\a':  if (mode == TOSTR_ESCAPE_MODE_C) short_form = 'a'; break;
+    case '\v':  if (mode == TOSTR_ESCAPE_MODE_C) short_form = 'v'; break;
+    }
+
+    if (short_form) {
+        sequence[0] = '\\';
+        sequence[1] = short_form;
+        return 2;
+    }
+
+    if (mode == TOSTR_ESCAPE_MODE_JSON) {
+        constexpr static char DIGITS[] = "0123456789abcdef";
+
+        memcpy(sequence, "\\u00", 4);
+        sequence[4] = DIGITS[c >> 4];
+        sequence[5] = DIGITS[c & 0x0F];
+        return 6;
+    } 
+
+    // octal escape sequence has always 3 digits, so following digit can not be taken as its part
+    sequence[0] = '\\';
+    sequence[1] = char('0' + (c >> 6));
+    sequence[2] = char('0' + ((c >> 3) & 7));
+    sequence[3] = char('0' + (c & 7));
+    return 4;
+}
+
+inline void ToStr_AppendEscaped(std::string& text, std::string_view text_to_escape, ToStr_EscapeMode mode) {
+    const char*     source  = text_to_escape.data();
+    const size_t    length  = text_to_escape.length();
+
+    char sequence[8];
+
+    // exact size, so text is allocated only once
+    size_t size = 0;
+    for (size_t index = 0; index < length; ++index) {
+        const size_t found = index + ToStr_FindToEscape(source + index, length - index, mode);
+        size += found - index;
+        if (found == length) break;
+
+        size += ToStr_Escape(source[found], mode, sequence);
+        index = found;
+    }
+
+    const size_t previous_length = text.length();
+    text.resize(previous_length + size);
+    char* target = &text[previous_length];
+
+    for (size_t index = 0; index < length; ++index) {
+        const size_t found = index + ToStr_FindToEscape(source + index, length - index, mode);
+        memcpy(target, source + index, found - index);
+        target += found - index;
+        if (found == length) break;
+
+        const size_t sequence_length = ToStr_Escape(source[found], mode, sequence);
+        memcpy(target, sequence, sequence_length);
+        target += sequence_length;
+        index = found;
+    }
+}
+
+inline std::string ToJSONEscaped(std::string_view text) {
+    std::string escaped_text;
+    ToStr_AppendEscaped(escaped_text, text, TOSTR_ESCAPE_MODE_JSON);
+    return escaped_text;
+}
+
+inline void AppendJSONEscaped(std::string& text, std::string_view text_to_escape) {
+    ToStr_AppendEscaped(text, text_to_escape, TOSTR_ESCAPE_MODE_JSON);
+}
+
+inline std::string ToCEscaped(std::string_view text) {
+    std::string escaped_text;
+    ToStr_AppendEscaped(escaped_text, text, TOSTR_ESCAPE_MODE_C);
+    return escaped_text;
+}
+
+inline void AppendCEscaped(std::string& text, std::string_view text_to_escape) {
+    ToStr_AppendEscaped(text, text_to_escape, TOSTR_ESCAPE_MODE_C);
+}
+
+//------------------------------------------------------------------------------
+
+// Parses 8 decimal digits at once (SWAR).
+// Returns              true    - if all 8 characters are digits (and adds them to 'value'),
+//                      false   - otherwise.
+inline bool ToStr_ParseEightDigits(const char* text, uint64_t& value) {
+    uint64_t chunk;
+    memcpy(&chunk, text, 8); // little endian
+
+    // each byte is in range '0'-'9'
+    if ((chunk & 0xF0F0F0F0F0F0F0F0ull) != 0x3030303030303030ull || ((chunk + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) != 0x3030303030303030ull) {
+        return false;
+    }
+
+    chunk -= 0x3030303030303030ull;
+    chunk = (chunk * 10 + (chunk >> 8)) & 0x00FF00FF00FF00FFull;
+    chunk = (chunk * 100 + (chunk >> 16)) & 0x0000FFFF0000FFFFull;
+    chunk = (chunk * 10000 + (chunk >> 32)) & 0x00000000FFFFFFFFull;
+
+    value = value * 100000000 + chunk;
+    return true;
+}
+
+template <typename Type>
+inline const char* ToStr_ParseInteger(const char* begin, const char* end, Type& value) {
+    const char* position    = begin;
+    bool        is_negative = false;
+
+    if (position < end && (*position == '+' || *position == '-')) {
+        is_negative = *position == '-';
+        ++position;
+    }
+    if (is_negative && !std::is_signed<Type>::value) return begin;
+
+    const char* digits_begin    = position;
+    uint64_t    magnitude       = 0;
+
+    // up to 16 digits can not overflow
+    while (end - position >= 8 && position - digits_begin <= 8 && ToStr_ParseEightDigits(position, magnitude)) position += 8;
+
+    for (; position < end && *position >= '0' && *position <= '9'; ++position) {
+        const unsigned digit = *position - '0';
+
+        if (magnitude > (UINT64_MAX - digit) / 10) return begin; // overflow
+        magnitude = magnitude * 10 + digit;
+    }
+
+    if (position == digits_begin) return begin;
+
+    const uint64_t limit = is_negative ? uint64_t((std::numeric_limits<Type>::max)()) + 1 : uint64_t((std::numeric_limits<Type>::max)());
+    if (magnitude > limit) return begin;
+
+    value = is_negative ? Type(0 - magnitude) : Type(magnitude);
+    return position;
+}
+
+template <typename Type>
+inline const char* ToStr_ParseFloat(const char* begin, const char* end, Type& value) {
+    constexpr static double POWERS_OF_TEN[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11, 
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+
+    const char* position    = begin;
+    bool        is_negative = false;
+
+    if (position < end && (*position == '+' || *position == '-')) {
+        is_negative = *position == '-';
+        ++position;
+    }
+
+    // Reads up to 19 significant digits to mantissa. Remaining digits only move decimal exponent.
+    uint64_t    mantissa            = 0;
+    int         significant_count   = 0;
+    int64_t     exponent            = 0;
+    bool        is_truncated        = false;
+    bool        is_digit            = false;
+
+    auto IsDigit = [&]() { return position < end && *position >= '0' && *position <= '9'; };
+
+    for (; IsDigit(); ++position, is_digit = true) {
+        if (significant_count < 19) {
+            mantissa = mantissa * 10 + (*position - '0');
+            if (mantissa) ++significant_count;
+        } else {
+            ++exponent;
+            if (*position != '0') is_truncated = true;
+        }
+    }
+
+    if (position < end && *position == '.') {
+        ++position;
+
+        for (; IsDigit(); ++position, is_digit = true) {
+            if (significant_count < 19) {
+                mantissa = mantissa * 10 + (*position - '0');
+                if (mantissa) ++significant_count;
+                --exponent;
+            } else {
+                if (*position != '0') is_truncated = true;
+            }
+        }
+    }
+
+    const bool is_special = !is_digit && position < end && (*position == 'i' || *position == 'I' || *position == 'n' || *position == 'N');
+
+    if (!is_digit && !is_special) return begin;
+
+    if (is_digit && position < end && (*position == 'e' || *position == 'E')) {
+        const char* exponent_position = position + 1;
+        bool        is_exponent_negative = false;
+
+        if (exponent_position < end && (*exponent_position == '+' || *exponent_position == '-')) {
+            is_exponent_negative = *exponent_position == '-';
+            ++exponent_position;
+        }
+
+        if (exponent_position < end && *exponent_position >= '0' && *exponent_position <= '9') {
+            int64_t explicit_exponent = 0;
+
+            for (; exponent_position < end && *exponent_position >= '0' && *exponent_position <= '9'; ++exponent_position) {
+                if (explicit_exponent < 100000) explicit_exponent = explicit_exponent * 10 + (*exponent_position - '0');
+            }
+
+            exponent += is_exponent_negative ? -explicit_exponent : explicit_exponent;
+            position = exponent_position;
+        } // otherwise 'e' is not a part of number
+    }
+
+#if FLT_EVAL_METHOD == 0
+    // Exact when mantissa and power of ten are exactly representable, then only one rounding happens (Clinger's fast path).
+    if (is_digit && !is_truncated) {
+        if (std::is_same<Type, float>::value) {
+            if (mantissa <= (uint64_t(1) << 24) && exponent >= -10 && exponent <= 10) {
+                float result = float(mantissa);
+                result = (exponent < 0) ? result / float(POWERS_OF_TEN[-exponent]) : result * float(POWERS_OF_TEN[exponent]);
+
+                value = Type(is_negative ? -result : result);
+                return position;
+            }
+        } else {
+            if (mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+                double result = double(mantissa);
+                result = (exponent < 0) ? result / POWERS_OF_TEN[-exponent] : result * POWERS_OF_TEN[exponent];
+
+                value = Type(is_negative ? -result : result);
+                return position;
+            }
+        }
+    }
+#endif
+
+    // Slow path. Parsing with "C" locale object, so global locale is not used.
+    static const _locale_t s_locale = _create_locale(LC_NUMERIC, "C");
+
+    // special values are short, digits are limited to already checked part
+    const size_t length = is_special ? ((end - begin < 64) ? (end - begin) : 64) : (position - begin);
+
+    char stack_buffer[TOSTR_MIN_BUFFER_SIZE];
+    char* buffer = (length + 1 > TOSTR_MIN_BUFFER_SIZE) ? (new char[length + 1]) : stack_buffer;
+
+    memcpy(buffer, begin, length);
+    buffer[length] = '\0';
+
+    char* buffer_end = buffer;
+    const Type result = std::is_same<Type, float>::value ? Type(_strtof_l(buffer, &buffer_end, s_locale)) : Type(_strtod_l(buffer, &buffer_end, s_locale));
+    const size_t parsed_length = buffer_end - buffer;
+
+    if (buffer != stack_buffer) delete[] buffer;
+
+    if (parsed_length == 0) return begin;
+    if (!is_special && std::isinf(result)) return begin; // out of range
+
+    value = result;
+    return begin + parsed_length;
+}
+
+template <typename Type>
+inline const char* FromStr(const char* begin, const char* end, Type& value) {
+    static_assert((std::is_integral<Type>::value && !std::is_same<Type, bool>::value) || std::is_same<Type, float>::value || std::is_same<Type, double>::value, 
+        "FromStr: Type must be an integer type, float or double.");
+
+    if constexpr (std::is_integral<Type>::value) {
+        return ToStr_ParseInteger(begin, end, value);
+    } else {
+        return ToStr_ParseFloat(begin, end, value);
+    }
+}
+
+template <typename Type>
+inline Type FromStr(std::string_view text, bool* is_parsed) {
+    Type value = Type();
+
+    const char* end = text.data() + text.size();
+    const bool is_parsed_entirely = !text.empty() && FromStr(text.data(), end, value) == end;
+
+    if (!is_parsed_entirely) value = Type();
+    if (is_parsed) *is_parsed = is_parsed_entirely;
+
+    return value;
+}
+
+template <typename... Types, size_t... INDICES>
+inline void ToStr_AppendToColumns(std::index_sequence<INDICES...>, const std::tuple<Types...>& values, std::vector<Types>&... columns) {
+    (columns.push_back(std::get<INDICES>(values)), ...);
+}
+
+template <typename... Types>
+inline bool FromStrColumns(std::string_view text, char delimiter, std::vector<Types>&... columns) {
+    const LineIndex line_index(text, true);
+
+    (columns.reserve(columns.size() + line_index.GetLineCount()), ...);
+
+    for (size_t index = 0; index < line_index.GetLineCount(); ++index) {
+        const std::string_view line = line_index.GetLine(index);
+        if (line.empty()) continue;
+
+        const char* position    = line.data();
+        const char* end         = line.data() + line.size();
+        bool        is_parsed   = true;
+        bool        is_first    = true;
+
+        auto ParseValue = [&](auto& value) {
+            if (!is_parsed) return;
+
+            if (!is_first) {
+                if (position == end || *position != delimiter) {
+                    is_parsed = false;
+                    return;
+                }
+                ++position;
+            }
+            is_first = false;
+
+            const char* next = FromStr(position, end, value);
+            if (next == position) is_parsed = false;
+            position = next;
+        };
+
+        std::tuple<Types...> values;
+        std::apply([&](auto&... value) { (ParseValue(value), ...); }, values);
+
+        if (!is_parsed || position != end) return false;
+
+        ToStr_AppendToColumns(std::index_sequence_for<Types...>(), values, columns...);
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+enum ToStr_ColumnType {
+    TOSTR_COLUMN_TYPE_INT8,
+    TOSTR_COLUMN_TYPE_INT16,
+    TOSTR_COLUMN_TYPE_INT32,
+    TOSTR_COLUMN_TYPE_INT64,
+    TOSTR_COLUMN_TYPE_UINT8,
+    TOSTR_COLUMN_TYPE_UINT16,
+    TOSTR_COLUMN_TYPE_UINT32,
+    TOSTR_COLUMN_TYPE_UINT64,
+    TOSTR_COLUMN_TYPE_FLOAT,
+    TOSTR_COLUMN_TYPE_DOUBLE,
+    TOSTR_COLUMN_TYPE_STRING,
+    TOSTR_COLUMN_TYPE_STRING_VIEW,
+    TOSTR_COLUMN_TYPE_C_STRING,
+};
+
+// How value from column is converted to text.
+enum ToStr_CellKernel {
+    TOSTR_CELL_KERNEL_DECIMAL,  // integer, without flags, width and precision
+    TOSTR_CELL_KERNEL_FIXED,    // floating point number with '%f', precision up to 9, without flags and width
+    TOSTR_CELL_KERNEL_STRING,   // string, without flags, width and precision
+    TOSTR_CELL_KERNEL_PRINTF,   // anything else (by 'snprintf')
+};
+
+struct ToStr_RowsColumn {
+    const void*         data;
+    ToStr_ColumnType    type;
+};
+
+struct ToStr_RowsCell {
+    std::string         prefix;         // text before conversion specification
+    std::string         spec;           // conversion specification for 'snprintf', with length modifier matching type of column
+    ToStr_CellKernel    kernel;
+    int                 precision;      // -1 if not present
+    bool                is_signed;      // if integer is converted as signed
+    bool                is_character;   // if integer is converted with '%c'
+};
+
+struct ToStr_RowsFormat {
+    std::vector<ToStr_RowsCell>     cells;  // one for each column
+    std::string                     suffix; // text after last conversion specification
+};
+
+enum { TOSTR_PRINT_ROWS_BATCH_SIZE = 256 }; // number of rows printed at once by ToStrPrintRows
+
+template <typename Type>
+constexpr ToStr_ColumnType ToStr_ToColumnType() {
+    if constexpr (std::is_same<Type, float>::value) {
+        return TOSTR_COLUMN_TYPE_FLOAT;
+    } else if constexpr (std::is_same<Type, double>::value) {
+        return TOSTR_COLUMN_TYPE_DOUBLE;
+    } else if constexpr (std::is_same<Type, std::string>::value) {
+        return TOSTR_COLUMN_TYPE_STRING;
+    } else if constexpr (std::is_same<Type, std::string_view>::value) {
+        return TOSTR_COLUMN_TYPE_STRING_VIEW;
+    } else if constexpr (std::is_same<Type, const char*>::value || std::is_same<Type, char*>::value) {
+        return TOSTR_COLUMN_TYPE_C_STRING;
+    } else {
+        static_assert(std::is_integral<Type>::value && !std::is_same<Type, bool>::value, 
+            "ToStrRows Error: Type of column must be integer type (except bool), float, double, std::string, std::string_view or const char*.");
+
+        constexpr int index = (sizeof(Type) == 1) ? 0 : (sizeof(Type) == 2) ? 1 : (sizeof(Type) == 4) ? 2 : 3;
+        return ToStr_ColumnType((std::is_signed<Type>::value ? TOSTR_COLUMN_TYPE_INT8 : TOSTR_COLUMN_TYPE_UINT8) + index);
+    }
+}
+
+inline bool ToStr_IsSignedColumn(ToStr_ColumnType type) {
+    return type >= TOSTR_COLUMN_TYPE_INT8 && type <= TOSTR_COLUMN_TYPE_INT64;
+}
+
+inline bool ToStr_IsIntegerColumn(ToStr_ColumnType type) {
+    return type >= TOSTR_COLUMN_TYPE_INT8 && type <= TOSTR_COLUMN_TYPE_UINT64;
+}
+
+inline bool ToStr_IsFloatColumn(ToStr_ColumnType type) {
+    return type == TOSTR_COLUMN_TYPE_FLOAT || type == TOSTR_COLUMN_TYPE_DOUBLE;
+}
+
+// Parses format once for all rows. Calls ToStr_FatalError, if format does not fit columns.
+inline void ToStr_ParseRowsFormat(const char* format, const ToStr_RowsColumn* columns, size_t column_count, ToStr_RowsFormat& rows_format) {
+    if (format == nullptr) {
+        ToStr_FatalError("ToStrRows Error: Argument 'format' can not be 0 or nullptr.");
+    }
+
+    rows_format.cells.clear();
+    rows_format.suffix.clear();
+
+    std::string text;
+    const char* position = format;
+
+    while (*position != '\0') {
+        if (*position != '%') {
+            text += *position++;
+            continue;
+        }
+        ++position;
+
+        if (*position == '%') {
+            text += *position++;
+            continue;
+        }
+
+        std::string flags;
+        while (*position != '\0' && strchr("-+ #0", *position)) flags += *position++;
+
+        std::string width;
+        while (*position >= '0' && *position <= '9') width += *position++;
+
+        bool        is_precision = false;
+        std::string precision;
+        if (*position == '.') {
+            ++position;
+            is_precision = true;
+            while (*position >= '0' && *position <= '9') precision += *position++;
+        }
+
+        if (*position == '*') {
+            ToStr_FatalError("ToStrRows Error: Width or precision given as '*' is not supported.");
+        }
+
+        // length modifiers are ignored
+        while (*position != '\0' && strchr("hlLzjtI", *position)) {
+            if (*position == 'I' && ((position[1] == '3' && position[2] == '2') || (position[1] == '6' && position[2] == '4'))) position += 2;
+            ++position;
+        }
+
+        const char conversion = *position;
+        if (conversion == '\0' || !strchr("diouxXcfFeEgGaAs", conversion)) {
+            ToStr_FatalError("ToStrRows Error: Unsupported conversion specification in format.");
+        }
+        ++position;
+
+        const size_t index = rows_format.cells.size();
+        if (index >= column_count) {
+            ToStr_FatalError("ToStrRows Error: Number of conversion specifications in format does not match number of columns.");
+        }
+        const ToStr_ColumnType type = columns[index].type;
+
+        ToStr_RowsCell cell = {};
+        cell.prefix     = std::move(text);
+        cell.precision  = is_precision ? atoi(precision.c_str()) : -1;
+        cell.spec       = "%" + flags + width;
+
+        const bool is_plain = flags.empty() && width.empty() && !is_precision;
+
+        if (strchr("diouxXc", conversion)) {
+            if (!ToStr_IsIntegerColumn(type)) {
+                ToStr_FatalError("ToStrRows Error: Conversion specification does not match type of column.");
+            }
+
+            // value of unsigned column is never converted to negative number
+            const char actual_conversion = ((conversion == 'd' || conversion == 'i') && !ToStr_IsSignedColumn(type)) ? 'u' : conversion;
+
+            cell.is_character   = actual_conversion == 'c';
+            cell.is_signed      = ToStr_IsSignedColumn(type) && (actual_conversion == 'd' || actual_conversion == 'i');
+            cell.kernel         = (is_plain && strchr("diu", actual_conversion)) ? TOSTR_CELL_KERNEL_DECIMAL : TOSTR_CELL_KERNEL_PRINTF;
+
+            if (is_precision) cell.spec += "." + precision;
+            if (!cell.is_character) cell.spec += "ll";
+            cell.spec += actual_conversion;
+
+        } else if (conversion == 's') {
+            if (ToStr_IsIntegerColumn(type) || ToStr_IsFloatColumn(type)) {
+                ToStr_FatalError("ToStrRows Error: Conversion specification does not match type of column.");
+            }
+
+            // strings are not null terminated, so their length is always given as precision
+            cell.kernel = is_plain ? TOSTR_CELL_KERNEL_STRING : TOSTR_CELL_KERNEL_PRINTF;
+            cell.spec += ".*s";
+
+        } else {
+            if (!ToStr_IsFloatColumn(type)) {
+                ToStr_FatalError("ToStrRows Error: Conversion specification does not match type of column.");
+            }
+
+            const bool is_fixed = (conversion == 'f' || conversion == 'F') && flags.empty() && width.empty() && cell.precision <= 9;
+
+            cell.kernel = is_fixed ? TOSTR_CELL_KERNEL_FIXED : TOSTR_CELL_KERNEL_PRINTF;
+            if (cell.kernel == TOSTR_CELL_KERNEL_FIXED && cell.precision < 0) cell.precision = 6;
+
+            if (is_precision) cell.spec += "." + precision;
+            cell.spec += conversion;
+        }
+
+        rows_format.cells.push_back(std::move(cell));
+    }
+
+    if (rows_format.cells.size() != column_count) {
+        ToStr_FatalError("ToStrRows Error: Number of conversion specifications in format does not match number of columns.");
+    }
+
+    rows_format.suffix = std::move(text);
+}
+
+// Only for signed columns.
+inline int64_t ToStr_ReadSigned(const ToStr_RowsColumn& column, size_t row) {
+    switch (column.type) {
+    case TOSTR_COLUMN_TYPE_INT8:    return static_cast<const int8_t*>(column.data)[row];
+    case TOSTR_COLUMN_TYPE_INT16:   return static_cast<const int16_t*>(column.data)[row];
+    case TOSTR_COLUMN_TYPE_INT32:   return static_cast<const int32_t*>(column.data)[row];
+    case TOSTR_COLUMN_TYPE_INT64:   return static_cast<const int64_t*>(column.data)[row];
+    default:
+        ToStr_FatalError("ToStrRows Error: Column is not signed integer column.");
+        return 0;
+    }
+}
+
+// Only for integer columns. Value of signed column is converted as 'printf' converts it for unsigned conversion: 
+// value smaller than 64 bit integer is promoted to int, then taken as unsigned int (for example: -128 is 0xFFFFFF80), 
+// 64 bit value is taken as unsigned 64 bit integer.
+inline uint64_t ToStr_ReadUnsigned(const ToStr_RowsColumn& column, size_t row) {
+    switch (column.type) {
+    case TOSTR_COLUMN_TYPE_INT8:
+    case TOSTR_COLUMN_TYPE_INT16:
+    case TOSTR_COLUMN_TYPE_INT32:   return uint32_t(int32_t(ToStr_ReadSigned(column, row)));
+    case TOSTR_COLUMN_TYPE_INT64:   return uint64_t(ToStr_ReadSigned(column, row));
+    case TOSTR_COLUMN_TYPE_UINT8:   return static_cast<const uint8_t*>(column.data)[row];
+    case TOSTR_COLUMN_TYPE_UINT16:  return static_cast<const uint16_t*>(column.data)[row];
+    case TOSTR_COLUMN_TYPE_UINT32:  return static_cast<const uint32_t*>(column.data)[row];
+    case TOSTR_COLUMN_TYPE_UINT64:  return static_cast<const uint64_t*>(column.data)[row];
+    default:
+        ToStr_FatalError("ToStrRows Error: Column is not integer column.");
+        return 0;
+    }
+}
+
+inline double ToStr_ReadFloat(const ToStr_RowsColumn& column, size_t row) {
+    if (column.type == TOSTR_COLUMN_TYPE_FLOAT) return static_cast<const float*>(column.data)[row];
+    return static_cast<const double*>(column.data)[row];
+}
+
+inline std::string_view ToStr_ReadString(const ToStr_RowsColumn& column, size_t row) {
+    switch (column.type) {
+    case TOSTR_COLUMN_TYPE_STRING:      return static_cast<const std::string*>(column.data)[row];
+    case TOSTR_COLUMN_TYPE_STRING_VIEW: return static_cast<const std::string_view*>(column.data)[row];
+    default: {
+        const char* text = static_cast<const char* const*>(column.data)[row];
+        if (text == nullptr) {
+            ToStr_FatalError("ToStrRows Error: String in column can not be 0 or nullptr.");
+        }
+        return text;
+    }
+    }
+}
+
+// Writes decimal digits of value, so they end right before 'end'.
+// Returns          Pointer to the first digit.
+inline char* ToStr_WriteDecimal(uint64_t value, char* end) {
+    static const char s_digit_pairs[] = 
+        "00010203040506070809" "10111213141516171819" "20212223242526272829" "30313233343536373839" "40414243444546474849"
+        "50515253545556575859" "60616263646566676869" "70717273747576777879" "80818283848586878889" "90919293949596979899";
+
+    while (value >= 100) {
+        const size_t index = size_t(value % 100) * 2;
+        value /= 100;
+        *--end = s_digit_pairs[index + 1];
+        *--end = s_digit_pairs[index];
+    }
+
+    if (value >= 10) {
+        const size_t index = size_t(value) * 2;
+        *--end = s_digit_pairs[index + 1];
+        *--end = s_digit_pairs[index];
+    } else {
+        *--end = char('0' + value);
+    }
+
+    return end;
+}
+
+// Converts floating point number as 'printf' with "%.<precision>f" does, but without calling it.
+// Number is scaled by power of ten and rounded. The result is used only when it is certain to be the same as the exact one: 
+// scaled number is below 2^40 (so its rounding error is below 2^-14), and it is not close to halfway between two integers.
+// buffer           Buffer for text. Text is placed at its end.
+// Returns          Pointer to the first character of text,
+//                  or nullptr if number must be converted by 'snprintf'.
+inline char* ToStr_WriteFixed(double value, int precision, char (&buffer)[64]) {
+    static const double     s_powers[]          = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
+    static const uint64_t   s_integer_powers[]  = {1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull};
+
+    if (!std::isfinite(value)) return nullptr;
+
+    const double scaled = std::fabs(value) * s_powers[precision];
+    if (!(scaled < 1099511627776.0)) return nullptr; // 2^40
+
+    const double integral   = std::floor(scaled);
+    const double fraction   = scaled - integral; // exact
+    if (std::fabs(fraction - 0.5) < 1.0 / 2048) return nullptr;
+
+    const uint64_t digits = uint64_t(integral) + (fraction > 0.5 ? 1 : 0);
+
+    char* position = buffer + sizeof(buffer);
+
+    if (precision > 0) {
+        char* const fraction_end = position;
+        position = ToStr_WriteDecimal(digits % s_integer_powers[precision], position);
+        while (fraction_end - position < precision) *--position = '0';
+        *--position = '.';
+    }
+
+    position = ToStr_WriteDecimal(digits / s_integer_powers[precision], position);
+
+    if (std::signbit(value)) *--position = '-';
+
+    return position;
+}
+
+template <typename... Types>
+inline void ToStr_AppendFormatted(std::string& text, const char* spec, Types... arguments) {
+    char stack_buffer[TOSTR_MIN_BUFFER_SIZE];
+
+    const int length = snprintf(stack_buffer, TOSTR_MIN_BUFFER_SIZE, spec, arguments...);
+
+    if (length < 0) {
+        ToStr_FatalError("ToStrRows Error: Encoding error.");
+    }
+
+    if (length >= TOSTR_MIN_BUFFER_SIZE) {
+        const size_t    size    = length + 1;
+        char*           buffer  = new char[size];
+
+        const int expected_same_length = snprintf(buffer, size, spec, arguments...);
+
+        if (expected_same_length != length) {
+            ToStr_FatalError("ToStrRows Error: Message actual length miss-match between first and second write to buffer.");
+        }
+
+        text.append(buffer, length);
+
+        delete[] buffer;
+    } else {
+        text.append(stack_buffer, length);
+    }
+}
+
+inline void ToStr_AppendCell(std::string& text, const ToStr_RowsCell& cell, const ToStr_RowsColumn& column, size_t row) {
+    char buffer[64];
+    char* const end = buffer + sizeof(buffer);
+
+    switch (cell.kernel) {
+    case TOSTR_CELL_KERNEL_DECIMAL: {
+        char* begin;
+        if (cell.is_signed) {
+            const int64_t value = ToStr_ReadSigned(column, row);
+            begin = ToStr_WriteDecimal((value < 0) ? (0 - uint64_t(value)) : uint64_t(value), end);
+            if (value < 0) *--begin = '-';
+        } else {
+            begin = ToStr_WriteDecimal(ToStr_ReadUnsigned(column, row), end);
+        }
+        text.append(begin, end - begin);
+        return;
+    }
+
+    case TOSTR_CELL_KERNEL_FIXED: {
+        const double value = ToStr_ReadFloat(column, row);
+
+        const char* begin = ToStr_WriteFixed(value, cell.precision, buffer);
+        if (begin) {
+            text.append(begin, end - begin);
+        } else {
+            ToStr_AppendFormatted(text, cell.spec.c_str(), value);
+        }
+        return;
+    }
+
+    case TOSTR_CELL_KERNEL_STRING:
+        text += ToStr_ReadString(column, row);
+        return;
+
+    default:
+        if (ToStr_IsIntegerColumn(column.type)) {
+            if (cell.is_character) {
+                ToStr_AppendFormatted(text, cell.spec.c_str(), int(ToStr_ReadUnsigned(column, row)));
+            } else if (cell.is_signed) {
+                ToStr_AppendFormatted(text, cell.spec.c_str(), (long long)ToStr_ReadSigned(column, row));
+            } else {
+                ToStr_AppendFormatted(text, cell.spec.c_str(), (unsigned long long)ToStr_ReadUnsigned(column, row));
+            }
+        } else if (ToStr_IsFloatColumn(column.type)) {
+            ToStr_AppendFormatted(text, cell.spec.c_str(), ToStr_ReadFloat(column, row));
+        } else {
+            const std::string_view value = ToStr_ReadString(column, row);
+            const size_t length = (cell.precision >= 0) ? (std::min)(value.size(), size_t(cell.precision)) : value.size();
+
+            ToStr_AppendFormatted(text, cell.spec.c_str(), int(length), value.data());
+        }
+        return;
+    }
+}
+
+// Appends text of rows from 'first_row' to 'end_row' (excluding).
+inline void ToStr_AppendRows(std::string& text, const ToStr_RowsFormat& rows_format, const ToStr_RowsColumn* columns, size_t first_row, size_t end_row) {
+    for (size_t row = first_row; row < end_row; ++row) {
+        for (size_t index = 0; index < rows_format.cells.size(); ++index) {
+            const ToStr_RowsCell& cell = rows_format.cells[index];
+
+            text += cell.prefix;
+            ToStr_AppendCell(text, cell, columns[index], row);
+        }
+        text += rows_format.suffix;
+    }
+}
+
+inline std::string ToStr_RowsToStr(unsigned thread_count, const char* format, const ToStr_RowsColumn* columns, size_t column_count, size_t row_count) {
+    ToStr_RowsFormat rows_format;
+    ToStr_ParseRowsFormat(format, columns, column_count, rows_format);
+
+    enum { MIN_ROW_COUNT_PER_THREAD = 1024 };
+
+    if (thread_count == 0) thread_count = (std::max)(std::thread::hardware_concurrency(), 1u);
+    thread_count = unsigned((std::max<size_t>)((std::min<size_t>)(thread_count, row_count / MIN_ROW_COUNT_PER_THREAD), 1));
+
+    std::vector<std::string> parts(thread_count);
+
+    auto AppendPart = [&](size_t index) {
+        const size_t first_row  = row_count * index / thread_count;
+        const size_t end_row    = row_count * (index + 1) / thread_count;
+
+        ToStr_AppendRows(parts[index], rows_format, columns, first_row, end_row);
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+
+    for (size_t index = 1; index < thread_count; ++index) threads.emplace_back(AppendPart, index);
+
+    AppendPart(0); // calling thread also converts rows
+
+    for (auto& thread : threads) thread.join();
+
+    if (thread_count == 1) return std::move(parts[0]);
+
+    size_t length = 0;
+    for (const auto& part : parts) length += part.length();
+
+    std::string text;
+    text.reserve(length);
+    for (const auto& part : parts) text += part;
+
+    return text;
+}
+
+inline bool ToStr_PrintRows(FILE* file, const char* format, const ToStr_RowsColumn* columns, size_t column_count, size_t row_count) {
+    if (file == nullptr) {
+        ToStr_FatalError("ToStrRows Error: Argument 'file' can not be 0 or nullptr.");
+    }
+
+    ToStr_RowsFormat rows_format;
+    ToStr_ParseRowsFormat(format, columns, column_count, rows_format);
+
+    std::string text;
+
+    for (size_t first_row = 0; first_row < row_count; first_row += TOSTR_PRINT_ROWS_BATCH_SIZE) {
+        text.clear();
+        ToStr_AppendRows(text, rows_format, columns, first_row, (std::min<size_t>)(first_row + TOSTR_PRINT_ROWS_BATCH_SIZE, row_count));
+
+        if (!ToStr_PrintText(file, text.c_str(), text.length())) return false;
+    }
+
+    return true;
+}
+
+template <typename Type, typename... Types>
+inline size_t ToStr_ToRowCount(const std::vector<Type>& column, const std::vector<Types>&... columns) {
+    if (((columns.size() != column.size()) || ...)) {
+        ToStr_FatalError("ToStrRows Error: Columns have different sizes.");
+    }
+    return column.size();
+}
+
+template <typename... Types>
+inline std::string ToStrRows(const char* format, const std::vector<Types>&... columns) {
+    return ToStrRows(1, format, columns...);
+}
+
+template <typename... Types>
+inline std::string ToStrRows(unsigned thread_count, const char* format, const std::vector<Types>&... columns) {
+    static_assert(sizeof...(Types) > 0, "ToStrRows Error: There must be at least one column.");
+
+    const ToStr_RowsColumn rows_columns[] = { {columns.data(), ToStr_ToColumnType<Types>()}... };
+
+    return ToStr_RowsToStr(thread_count, format, rows_columns, sizeof...(Types), ToStr_ToRowCount(columns...));
+}
+
+template <typename... Types>
+inline bool ToStrPrintRows(FILE* file, const char* format, const std::vector<Types>&... columns) {
+    static_assert(sizeof...(Types) > 0, "ToStrRows Error: There must be at least one column.");
+
+    const ToStr_RowsColumn rows_columns[] = { {columns.data(), ToStr_ToColumnType<Types>()}... };
+
+    return ToStr_PrintRows(file, format, rows_columns, sizeof...(Types), ToStr_ToRowCount(columns...));
+}
+
+//------------------------------------------------------------------------------
+
+class ToStr_LocaleGuardian {
+public:
+    ToStr_LocaleGuardian(int category, const char* locale) {
+        char* beckup = setlocale(LC_ALL, ".UTF8");
+        m_backup = beckup ? std::string(beckup) : "";
+    }
+    virtual ~ToStr_LocaleGuardian() {
+        if (!m_backup.empty()) setlocale(LC_ALL, m_backup.c_str());
+    }
+private:
+    std::string m_backup;
+};
+
+#define TOSTR_LOCALE_GUARDIAN_UTF8() ToStr_LocaleGuardian locale_guardian_utf8(LC_ALL, ".UTF8")
+
+inline std::string LoadTextFromFile(const std::string& file_name, bool* is_loaded) {
+    std::string text;
+
+    FILE* file = nullptr;
+    if (fopen_s(&file, file_name.c_str(), "rt") == 0 && file) {
+
+        char c;
+        while ((c = fgetc(file)) != EOF) text += c;
+        fclose(file);
+
+        if (is_loaded) *is_loaded = true;
+    } else {
+        if (is_loaded) *is_loaded = false;
+    }
+
+    return text;
+}
+
+inline std::string LoadTextFromFileUTF8(const std::string& file_name, bool* is_loaded) {
+    std::string text;
+
+    FILE* file = nullptr;
+    if (_wfopen_s(&file, ToUTF16(file_name).c_str(), L"rb") == 0 && file) {
+        char buffer[TOSTR_MIN_BUFFER_SIZE];
+        size_t count;
+
+        while ((count = fread(buffer, sizeof(char), TOSTR_MIN_BUFFER_SIZE, file)) > 0) {
+            // suppress 'carriage return' (CR), copies whole runs between them
+            const char* begin   = buffer;
+            const char* end     = buffer + count;
+
+            while (begin < end) {
+                const char* cr = (const char*)memchr(begin, '\r', end - begin);
+                if (!cr) cr = end;
+
+                text.append(begin, cr);
+                begin = cr + 1;
+            }
+        }
+
+        const bool is_all_read = feof(file);
+
+        fclose(file);
+
+        if (is_loaded) *is_loaded = is_all_read;
+    } else {
+        if (is_loaded) *is_loaded = false;
+    }
+
+    return text;
+}
+
+inline std::string LoadTextFromFileUTF8_BOM(const std::string& file_name, bool* is_loaded) {
+    std::wstring text;
+
+    FILE* file = nullptr;
+    if (_wfopen_s(&file, ToUTF16(file_name).c_str(), L"rt, ccs=UTF-8") == 0 && file) {
+
+        wchar_t c;
+        while ((c = fgetwc(file)) != WEOF) text += c;
+        fclose(file);
+
+        if (is_loaded) *is_loaded = true;
+    } else {
+        if (is_loaded) *is_loaded = false;
+    }
+
+    return ToUTF8(text);
+}
+
+inline std::vector<LoadedTextFile> LoadTextFromFiles(const std::vector<std::string>& file_names, ToStr_LoadMode mode, unsigned thread_count) {
+    std::vector<LoadedTextFile> loaded_files(file_names.size());
+
+    std::atomic<size_t> next_index(0);
+
+    auto LoadFiles = [&]() {
+        for (size_t index = next_index++; index < file_names.size(); index = next_index++) {
+            LoadedTextFile& loaded_file = loaded_files[index];
+
+            switch (mode) {
+            case TOSTR_LOAD_MODE_ASCII:     loaded_file.text = LoadTextFromFile(file_names[index], &loaded_file.is_loaded);         break;
+            case TOSTR_LOAD_MODE_UTF8:      loaded_file.text = LoadTextFromFileUTF8(file_names[index], &loaded_file.is_loaded);     break;
+            case TOSTR_LOAD_MODE_UTF8_BOM:  loaded_file.text = LoadTextFromFileUTF8_BOM(file_names[index], &loaded_file.is_loaded); break;
+            default:
+                ToStr_FatalError("LoadTextFromFiles Error: Unknown load mode.");
+            }
+        }
+    };
+
+    if (thread_count == 0) thread_count = std::thread::hardware_concurrency();
+    if (thread_count > file_names.size()) thread_count = unsigned(file_names.size());
+
+    if (thread_count > 1) {
+        // calling thread is one of loading threads
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count - 1);
+
+        for (unsigned index = 1; index < thread_count; ++index) threads.emplace_back(LoadFiles);
+        LoadFiles();
+        for (auto& thread : threads) thread.join();
+    } else {
+        LoadFiles();
+    }
+
+    return loaded_files;
+}
+
+//------------------------------------------------------------------------------
+
+inline TextFileCache::TextFileCache(size_t byte_budget, ToStr_LoadMode mode) : m_byte_size(0), m_byte_budget(byte_budget), m_mode(mode) {}
+
+inline std::shared_ptr<const std::string> TextFileCache::Load(const std::string& file_name, bool* is_loaded) {
+    const Stamp stamp = ToStamp(file_name);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    auto it = m_entry_map.find(file_name);
+    if (it != m_entry_map.end() && it->second->stamp == stamp) {
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+
+        if (is_loaded) *is_loaded = it->second->is_loaded;
+        return it->second->text;
+    }
+
+    auto pending_it = m_pending_loads.find(file_name);
+    if (pending_it != m_pending_loads.end()) {
+        std::shared_future<Entry> pending_load = pending_it->second;
+        lock.unlock();
+
+        const Entry& entry = pending_load.get();
+
+        if (is_loaded) *is_loaded = entry.is_loaded;
+        return entry.text;
+    }
+
+    std::promise<Entry> promise;
+    m_pending_loads[file_name] = promise.get_future().share();
+    lock.unlock();
+
+    Entry entry;
+    try {
+        std::string text;
+
+        switch (m_mode) {
+        case TOSTR_LOAD_MODE_ASCII:     text = LoadTextFromFile(file_name, &entry.is_loaded);           break;
+        case TOSTR_LOAD_MODE_UTF8:      text = LoadTextFromFileUTF8(file_name, &entry.is_loaded);       break;
+        case TOSTR_LOAD_MODE_UTF8_BOM:  text = LoadTextFromFileUTF8_BOM(file_name, &entry.is_loaded);   break;
+        default:
+            ToStr_FatalError("TextFileCache Error: Unknown load mode.");
+        }
+
+        entry.file_name = file_name;
+        entry.stamp     = stamp; // taken before reading, so a change during reading is detected at next load
+        entry.text      = std::make_shared<const std::string>(std::move(text));
+    } catch (...) {
+        lock.lock();
+        m_pending_loads.erase(file_name);
+        lock.unlock();
+
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+
+    lock.lock();
+    m_pending_loads.erase(file_name);
+    if (entry.is_loaded) Insert(entry); // failed load is not cached, so the next load tries again
+    lock.unlock();
+
+    promise.set_value(entry);
+
+    if (is_loaded) *is_loaded = entry.is_loaded;
+    return entry.text;
+}
+
+inline void TextFileCache::Remove(const std::string& file_name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_entry_map.find(file_name);
+    if (it != m_entry_map.end()) {
+        m_byte_size -= it->second->text->size();
+        m_entries.erase(it->second);
+        m_entry_map.erase(it);
+    }
+}
+
+inline void TextFileCache::Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_entries.clear();
+    m_entry_map.clear();
+    m_byte_size = 0;
+}
+
+inline void TextFileCache::SetByteBudget(size_t byte_budget) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_byte_budget = byte_budget;
+    Evict();
+}
+
+inline size_t TextFileCache::GetByteBudget() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_byte_budget;
+}
+
+inline size_t TextFileCache::GetByteSize() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_byte_size;
+}
+
+inline bool TextFileCache::Stamp::operator==(const Stamp& other) const {
+    return is_exist == other.is_exist && size == other.size && last_write_time == other.last_write_time;
+}
+
+inline TextFileCache::Stamp TextFileCache::ToStamp(const std::string& file_name) {
+    Stamp stamp = {};
+
+    WIN32_FILE_ATTRIBUTE_DATA data = {};
+    if (GetFileAttributesExW(ToUTF16(file_name).c_str(), GetFileExInfoStandard, &data)) {
+        stamp.is_exist          = true;
+        stamp.size              = (uint64_t(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+        stamp.last_write_time   = (uint64_t(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+    }
+
+    return stamp;
+}
+
+inline void TextFileCache::Insert(Entry entry) {
+    auto it = m_entry_map.find(entry.file_name);
+    if (it != m_entry_map.end()) {
+        m_byte_size -= it->second->text->size();
+        m_entries.erase(it->second);
+        m_entry_map.erase(it);
+    }
+
+    m_byte_size += entry.text->size();
+    m_entries.push_front(std::move(entry));
+    m_entry_map[m_entries.front().file_name] = m_entries.begin();
+
+    Evict();
+}
+
+inline void TextFileCache::Evict() {
+    while (m_byte_size > m_byte_budget && !m_entries.empty()) {
+        const Entry& entry = m_entries.back();
+
+        m_byte_size -= entry.text->size();
+        m_entry_map.erase(entry.file_name);
+        m_entries.pop_back();
+    }
+}
+
+//------------------------------------------------------------------------------
+
+inline LineIndex::LineIndex() : m_is_crlf(false), m_is_offset64(false), m_line_count(0) {}
+
+inline LineIndex::LineIndex(std::string_view text, bool is_crlf) : LineIndex() {
+    Build(text, is_crlf);
+}
+
+inline void LineIndex::Build(std::string_view text, bool is_crlf) {
+    m_text      = text;
+    m_is_crlf   = is_crlf;
+
+    m_is_offset64 = text.size() > UINT32_MAX;
+
+    m_line_ends32.clear();
+    m_line_ends64.clear();
+
+    if (m_is_offset64) {
+        Scan(text, m_line_ends64);
+    } else {
+        Scan(text, m_line_ends32);
+    }
+
+    m_line_count = GetSeparatorCount();
+
+    if (!text.empty() && text.back() != '\n') ++m_line_count; // last line without '\n'
+}
+
+template <typename Offset>
+inline void LineIndex::Scan(std::string_view text, std::vector<Offset>& line_ends) {
+    const char* data    = text.data();
+    const size_t size   = text.size();
+    size_t index        = 0;
+
+#ifdef TOSTR_SSE2
+    const __m128i new_line = _mm_set1_epi8('\n');
+
+    for (; index + 16 <= size; index += 16) {
+        const __m128i chunk = _mm_loadu_si128((const __m128i*)(data + index));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, new_line));
+
+        while (mask) {
+            line_ends.push_back(Offset(index + ToStr_CountTrailingZeros(mask)));
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    while (index < size) {
+        const char* found = (const char*)memchr(data + index, '\n', size - index);
+        if (!found) break;
+
+        index = found - data;
+        line_ends.push_back(Offset(index));
+        ++index;
+    }
+}
+
+inline size_t LineIndex::GetLineCount() const {
+    return m_line_count;
+}
+
+inline std::string_view LineIndex::GetLine(size_t index) const {
+    if (index >= m_line_count) {
+        ToStr_FatalError("LineIndex Error: Line index out of range.");
+    }
+
+    const size_t begin = GetLineBegin(index);
+    return m_text.substr(begin, GetLineEnd(index) - begin);
+}
+
+inline std::string_view LineIndex::GetText(const Range& range) const {
+    if (range.count == 0 || range.first + range.count > m_line_count) {
+        ToStr_FatalError("LineIndex Error: Line range out of range.");
+    }
+
+    const size_t begin = GetLineBegin(range.first);
+    return m_text.substr(begin, GetLineEnd(range.first + range.count - 1) - begin);
+}
+
+inline std::vector<LineIndex::Range> LineIndex::Split(size_t range_count) const {
+    std::vector<Range> ranges;
+
+    if (range_count == 0 || m_line_count == 0) return ranges;
+
+    const size_t size = m_text.size();
+
+    size_t first = 0;
+    for (size_t index = 1; index <= range_count && first < m_line_count; ++index) {
+        // size * index / range_count, without overflow
+        const size_t position = size / range_count * index + size % range_count * index / range_count;
+
+        size_t next = (index == range_count) ? m_line_count : FindSeparator(position);
+        if (next > m_line_count) next = m_line_count;
+
+        if (next > first) {
+            ranges.push_back({first, next - first});
+            first = next;
+        }
+    }
+
+    return ranges;
+}
+
+inline size_t LineIndex::GetSeparatorCount() const {
+    return m_is_offset64 ? m_line_ends64.size() : m_line_ends32.size();
+}
+
+inline size_t LineIndex::GetSeparatorPosition(size_t index) const {
+    return m_is_offset64 ? size_t(m_line_ends64[index]) : size_t(m_line_ends32[index]);
+}
+
+inline size_t LineIndex::FindSeparator(size_t position) const {
+    if (m_is_offset64) {
+        return std::lower_bound(m_line_ends64.begin(), m_line_ends64.end(), uint64_t(position)) - m_line_ends64.begin();
+    }
+    return std::lower_bound(m_line_ends32.begin(), m_line_ends32.end(), position) - m_line_ends32.begin();
+}
+
+inline size_t LineIndex::GetLineBegin(size_t index) const {
+    if (index == 0) return 0;
+    return GetSeparatorPosition(index - 1) + 1;
+}
+
+inline size_t LineIndex::GetLineEnd(size_t index) const {
+    size_t end = m_text.size();
+
+    if (index < GetSeparatorCount()) {
+        end = GetSeparatorPosition(index);
+
+        if (m_is_crlf && end > GetLineBegin(index) && m_text[end - 1] == '\r') --end;
+    }
+
+    return end;
+}
+
+//------------------------------------------------------------------------------
+
+inline bool SaveTextToFile(const std::string& file_name, const std::string& text) {
+    FILE* file = nullptr;
+    if (fopen_s(&file, file_name.c_str(), "wt") == 0 && file) {
+        const int count = fprintf(file, "%s", text.c_str());
+        fclose(file);
+
+        return count == text.length();
+    }
+
+    return false;
+}
+
+// Writes utf8 text to file. Inserts carriage returns, if needed.
+inline bool ToStr_WriteUTF8(FILE* file, const std::string& text, ToStr_NewLine new_line) {
+    if (new_line == TOSTR_NEW_LINE_LF) {
+        return fwrite(text.c_str(), sizeof(char), text.length(), file) == text.length();
+    }
+
+    const char*     source      = text.c_str();
+    const size_t    length      = text.length();
+    size_t          index       = 0;
+
+    // runs between new lines are written as they are
+    while (index < length) {
+        const char* found       = (const char*)memchr(source + index, '\n', length - index);
+        const size_t run_end    = found ? (found - source) : length;
+
+        if (fwrite(source + index, sizeof(char), run_end - index, file) != run_end - index) return false;
+
+        if (found) {
+            const bool is_cr = run_end > 0 && source[run_end - 1] == '\r';
+            if (fwrite(is_cr ? "\n" : "\r\n", sizeof(char), is_cr ? 1 : 2, file) != (is_cr ? 1 : 2)) return false;
+        }
+
+        index = run_end + 1;
+    }
+
+    return true;
+}
+
+// Converts utf8 text to utf16 in chunks and writes them to file. Inserts carriage returns, if needed.
+inline bool ToStr_WriteUTF16(FILE* file, const std::string& text, ToStr_ByteOrder byte_order, ToStr_NewLine new_line, bool is_bom) {
+    const unsigned char*    source  = (const unsigned char*)text.c_str();
+    const size_t            length  = text.length();
+
+    char16_t    buffer[TOSTR_MIN_BUFFER_SIZE];
+    size_t      count = 0;
+
+    auto Flush = [&]() -> bool {
+        if (byte_order == TOSTR_BYTE_ORDER_BE) {
+            for (size_t index = 0; index < count; ++index) buffer[index] = char16_t((buffer[index] >> 8) | (buffer[index] << 8));
+        }
+
+        const bool is_written = fwrite(buffer, sizeof(char16_t), count, file) == count;
+        count = 0;
+        return is_written;
+    };
+
+    if (is_bom) buffer[count++] = 0xFEFF;
+
+    const bool is_crlf = new_line == TOSTR_NEW_LINE_CRLF;
+
+    char32_t    previous    = 0;
+    size_t      index       = 0;
+
+    while (index < length) {
+        // there is always space for 16 code units
+        if (count + 16 > TOSTR_MIN_BUFFER_SIZE && !Flush()) return false;
+
+        if (index + 16 <= length && ToStr_IsASCII16((const char*)source + index) && !(is_crlf && memchr(source + index, '\n', 16))) {
+#ifdef TOSTR_SSE2
+            const __m128i zero  = _mm_setzero_si128();
+            const __m128i bytes = _mm_loadu_si128((const __m128i*)(source + index));
+
+            _mm_storeu_si128((__m128i*)(buffer + count + 0), _mm_unpacklo_epi8(bytes, zero));
+            _mm_storeu_si128((__m128i*)(buffer + count + 8), _mm_unpackhi_epi8(bytes, zero));
+#else
+            for (size_t offset = 0; offset < 16; ++offset) buffer[count + offset] = source[index + offset];
+#endif
+            count   += 16;
+            index   += 16;
+            previous = source[index - 1];
+        } else {
+            char32_t code;
+            index += ToStr_DecodeUTF8(source + index, length - index, code);
+
+            if (is_crlf && code == '\n' && previous != '\r') buffer[count++] = '\r';
+
+            if (code >= 0x10000) {
+                buffer[count++] = char16_t(0xD800 + ((code - 0x10000) >> 10));
+                buffer[count++] = char16_t(0xDC00 + ((code - 0x10000) & 0x3FF));
+            } else {
+                buffer[count++] = char16_t(code);
+            }
+
+            previous = code;
+        }
+    }
+
+    return Flush();
+}
+
+inline bool SaveTextToFileUTF8(const std::string& file_name, const std::string& text, ToStr_NewLine new_line) {
+    FILE* file = nullptr;
+    if (_wfopen_s(&file, ToUTF16(file_name).c_str(), L"wb") == 0 && file) {
+        const bool is_written = ToStr_WriteUTF8(file, text, new_line);
+        fclose(file);
+
+        return is_written;
     }
 
     return false;
 }
 
-inline bool SaveTextToFileUTF8_BOM(const std::string& file_name, const std::string& text) {
+inline bool SaveTextToFileUTF8_BOM(const std::string& file_name, const std::string& text, ToStr_NewLine new_line) {
     FILE* file = nullptr;
     if (_wfopen_s(&file, ToUTF16(file_name).c_str(), L"wb") == 0 && file) {
 
@@ -383,7 +3204,7 @@ inline bool SaveTextToFileUTF8_BOM(const std::string& file_name, const std::stri
 
         const bool is_wirten = 
             fwrite(BOM, sizeof(char), sizeof(BOM), file) == 3 &&
-            fwrite(text.c_str(), sizeof(char), text.length(), file) == text.length();
+            ToStr_WriteUTF8(file, text, new_line);
 
         fclose(file);
 
@@ -393,4 +3214,40 @@ inline bool SaveTextToFileUTF8_BOM(const std::string& file_name, const std::stri
     return false;
 }
 
+inline bool SaveTextToFileUTF16(const std::string& file_name, const std::string& text, ToStr_ByteOrder byte_order, ToStr_NewLine new_line) {
+    FILE* file = nullptr;
+    if (_wfopen_s(&file, ToUTF16(file_name).c_str(), L"wb") == 0 && file) {
+        const bool is_written = ToStr_WriteUTF16(file, text, byte_order, new_line, false);
+        fclose(file);
+
+        return is_written;
+    }
+
+    return false;
+}
+
+inline bool SaveTextToFileUTF16_BOM(const std::string& file_name, const std::string& text, ToStr_ByteOrder byte_order, ToStr_NewLine new_line) {
+    FILE* file = nullptr;
+    if (_wfopen_s(&file, ToUTF16(file_name).c_str(), L"wb") == 0 && file) {
+        const bool is_written = ToStr_WriteUTF16(file, text, byte_order, new_line, true);
+        fclose(file);
+
+        return is_written;
+    }
+
+    return false;
+}
+
+inline bool SaveTextToFileUTF8(const std::string& file_name, const ToStrBuilder& builder) {
+    FILE* file = nullptr;
+    if (_wfopen_s(&file, ToUTF16(file_name).c_str(), L"wb") == 0 && file) {
+        const bool is_written = builder.WriteToFile(file);
+        fclose(file);
+
+        return is_written;
+    }
+
+    return false;
+}
+
 #endif // TOSTR_H_